@@ -5,6 +5,8 @@
 #include <time.h>
 
 #include "graphics.h"
+#include "profile.h"
+#include "time_service.h"
 
 typedef enum {
     WIDGET_THEME_LIGHT,
@@ -13,12 +15,33 @@ typedef enum {
 
 typedef struct Widget Widget;
 
+// Wake sources that run a widget's on_update (see widget_scheduler.h).
+// Touch and mic are app-wide events a widget subscribes to; the timer and
+// invalidation belong to one widget.
+typedef enum {
+    WIDGET_WAKE_TOUCH = 1 << 0,         // Pen down, held or released
+    WIDGET_WAKE_MIC = 1 << 1,           // A microphone buffer arrived
+    WIDGET_WAKE_TIMER = 1 << 2,         // Every wake_period frames
+    WIDGET_WAKE_INVALIDATE = 1 << 3,    // widget_invalidate or a config change
+    WIDGET_WAKE_RESUME = 1 << 4         // widget_resume: finish a sliced redraw
+} WidgetWake;
+
+// Low-priority updates wait for a later frame when the frame governor says
+// the frame is running late; high-priority ones always run
+typedef enum {
+    WIDGET_PRIORITY_HIGH,
+    WIDGET_PRIORITY_LOW
+} WidgetPriority;
+
 typedef struct {
     void (*on_attach)(Widget* widget, GraphicsContext* context);
     void (*on_detach)(Widget* widget);
     void (*on_theme_changed)(Widget* widget, WidgetTheme theme);
     void (*on_rotation_changed)(Widget* widget, RotationAngle rotation);
     void (*on_layout_changed)(Widget* widget, bool split_mode);
+    // Physical cell the layout gave the widget; the widget insets its own
+    // content from it
+    void (*on_bounds_changed)(Widget* widget, int x, int y, int w, int h);
     void (*on_time_tick)(Widget* widget, const struct tm* timeinfo);
     void (*on_update)(Widget* widget);
 } WidgetOps;
@@ -29,6 +52,31 @@ struct Widget {
     WidgetTheme theme;
     RotationAngle rotation;
     bool split_mode;
+    // Physical screen area the widget may draw into, pushed as the context's
+    // clip around every callback that can draw
+    GfxRect clip;
+    bool has_clip;
+    // TimeChange bits that deliver on_time_tick (TIME_CHANGE_SECOND by default)
+    unsigned time_mask;
+    // WidgetWake events that run on_update, the timer period in frames
+    // (0 = off) and what is waiting to be delivered
+    unsigned wake_mask;
+    int wake_period;
+    int wake_countdown;
+    unsigned wake_pending;
+    unsigned wake_reasons;  // What woke the running on_update
+    u32 wakeups;            // Callbacks delivered, for the per-second report
+    // Frame budget: cycles one callback may take before a sliced redraw
+    // stops (0 = unbudgeted), and the rate below which a low-priority
+    // widget is no longer deferred
+    WidgetPriority priority;
+    u32 budget_cycles;
+    int rate_hz;
+    int deferred_frames;    // Frames the pending update has been held back
+    u32 run_start;          // profile_ticks() when the running callback began
+    u32 max_cycles;         // Longest callback, for the profile report
+    u32 overruns;           // Callbacks over budget_cycles
+    u32 deferrals;          // Updates held back by the governor
     void* state;
     const WidgetOps* ops;
 };
@@ -45,6 +93,135 @@ static inline void widget_init(Widget* widget, const char* name, void* state, co
     widget->theme = WIDGET_THEME_LIGHT;
     widget->rotation = ROTATION_0;
     widget->split_mode = false;
+    widget->has_clip = false;
+    widget->time_mask = TIME_CHANGE_SECOND;
+    widget->wake_mask = 0;
+    widget->wake_period = 0;
+    widget->wake_countdown = 0;
+    widget->wake_pending = WIDGET_WAKE_INVALIDATE;
+    widget->wake_reasons = 0;
+    widget->wakeups = 0;
+    widget->priority = WIDGET_PRIORITY_HIGH;
+    widget->budget_cycles = 0;
+    widget->rate_hz = 0;
+    widget->deferred_frames = 0;
+    widget->run_start = 0;
+    widget->max_cycles = 0;
+    widget->overruns = 0;
+    widget->deferrals = 0;
+}
+
+// Choose which time changes wake the widget; 0 stops its ticks
+static inline void widget_subscribe_time(Widget* widget, unsigned mask) {
+    if (!widget) {
+        return;
+    }
+
+    widget->time_mask = mask;
+}
+
+// Choose which app-wide events (WIDGET_WAKE_TOUCH, WIDGET_WAKE_MIC) run
+// on_update
+static inline void widget_subscribe_wake(Widget* widget, unsigned mask) {
+    if (!widget) {
+        return;
+    }
+
+    widget->wake_mask = mask;
+}
+
+// Run on_update every `frames` frames (1 = every frame, 0 = never). The
+// countdown restarts only when the period changes.
+static inline void widget_set_wake_timer(Widget* widget, int frames) {
+    if (!widget || widget->wake_period == frames) {
+        return;
+    }
+
+    widget->wake_period = frames;
+    widget->wake_countdown = frames;
+}
+
+// Run on_update once on the next frame
+static inline void widget_invalidate(Widget* widget) {
+    if (!widget) {
+        return;
+    }
+
+    widget->wake_pending |= WIDGET_WAKE_INVALIDATE;
+}
+
+// Declare how long one callback may run and how often the widget must get
+// to run at least (0 Hz = any deferral is fine)
+static inline void widget_set_budget(Widget* widget, int rate_hz, u32 budget_cycles, WidgetPriority priority) {
+    if (!widget) {
+        return;
+    }
+
+    widget->rate_hz = rate_hz;
+    widget->budget_cycles = budget_cycles;
+    widget->priority = priority;
+}
+
+// Whether the running callback has used up its budget. Sliced redraws
+// check it between slices and call widget_resume for the rest.
+static inline bool widget_over_budget(const Widget* widget) {
+    if (!widget || widget->budget_cycles == 0) {
+        return false;
+    }
+
+    return (profile_ticks() - widget->run_start) * PROFILE_CYCLES_PER_TICK > widget->budget_cycles;
+}
+
+// Continue on_update on the next frame
+static inline void widget_resume(Widget* widget) {
+    if (!widget) {
+        return;
+    }
+
+    widget->wake_pending |= WIDGET_WAKE_RESUME;
+}
+
+static inline void widget_begin_run(Widget* widget) {
+    widget->wakeups++;
+    widget->run_start = profile_ticks();
+}
+
+static inline void widget_end_run(Widget* widget) {
+    u32 cycles = (profile_ticks() - widget->run_start) * PROFILE_CYCLES_PER_TICK;
+    if (cycles > widget->max_cycles) {
+        widget->max_cycles = cycles;
+    }
+    if (widget->budget_cycles && cycles > widget->budget_cycles) {
+        widget->overruns++;
+    }
+}
+
+static inline void widget_set_clip(Widget* widget, int x, int y, int w, int h) {
+    if (!widget) {
+        return;
+    }
+
+    widget->clip.x = x;
+    widget->clip.y = y;
+    widget->clip.width = w;
+    widget->clip.height = h;
+    widget->has_clip = true;
+}
+
+// Bracket a callback that may draw; returns whether a clip was pushed
+static inline bool widget_begin_draw(Widget* widget) {
+    if (!widget->context || !widget->has_clip) {
+        return false;
+    }
+
+    const GfxRect* clip = &widget->clip;
+    return gfx_push_clip(widget->context, clip->x, clip->y, clip->width, clip->height);
+}
+
+static inline void widget_end_draw(Widget* widget, bool clipped) {
+    if (clipped) {
+        gfx_pop_clip(widget->context);
+    }
 }
 
 static inline void widget_attach(Widget* widget, GraphicsContext* context) {
@@ -54,8 +231,11 @@ static inline void widget_attach(Widget* widget, GraphicsContext* context) {
 
     widget->context = context;
     if (widget->ops && widget->ops->on_attach) {
+        bool clipped = widget_begin_draw(widget);
         widget->ops->on_attach(widget, context);
+        widget_end_draw(widget, clipped);
     }
+    widget_invalidate(widget);
 }
 
 static inline void widget_detach(Widget* widget) {
@@ -81,8 +261,11 @@ static inline void widget_set_theme(Widget* widget, WidgetTheme theme) {
 
     widget->theme = theme;
     if (widget->ops && widget->ops->on_theme_changed) {
+        bool clipped = widget_begin_draw(widget);
         widget->ops->on_theme_changed(widget, theme);
+        widget_end_draw(widget, clipped);
     }
+    widget_invalidate(widget);
 }
 
 static inline void widget_set_rotation(Widget* widget, RotationAngle rotation) {
@@ -96,8 +279,11 @@ static inline void widget_set_rotation(Widget* widget, RotationAngle rotation) {
 
     widget->rotation = rotation;
     if (widget->ops && widget->ops->on_rotation_changed) {
+        bool clipped = widget_begin_draw(widget);
         widget->ops->on_rotation_changed(widget, rotation);
+        widget_end_draw(widget, clipped);
     }
+    widget_invalidate(widget);
 }
 
 static inline void widget_set_split_mode(Widget* widget, bool split_mode) {
@@ -111,16 +297,43 @@ static inline void widget_set_split_mode(Widget* widget, bool split_mode) {
 
     widget->split_mode = split_mode;
     if (widget->ops && widget->ops->on_layout_changed) {
+        bool clipped = widget_begin_draw(widget);
         widget->ops->on_layout_changed(widget, split_mode);
+        widget_end_draw(widget, clipped);
+    }
+    widget_invalidate(widget);
+}
+
+// Margin between a cell and the content inside it: 2 pixels once the cell
+// is larger than min_size both ways
+static inline int widget_cell_margin(int w, int h, int min_size) {
+    return (w > min_size && h > min_size) ? 2 : 0;
+}
+
+static inline void widget_set_bounds(Widget* widget, int x, int y, int w, int h) {
+    if (!widget || !widget->ops || !widget->ops->on_bounds_changed) {
+        return;
     }
+
+    widget->ops->on_bounds_changed(widget, x, y, w, h);
+    widget_invalidate(widget);
 }
 
-static inline void widget_time_tick(Widget* widget, const struct tm* timeinfo) {
+// Deliver a tick if `changed` has any of the widget's TimeChange bits
+static inline void widget_time_tick(Widget* widget, const struct tm* timeinfo, unsigned changed) {
     if (!widget || !widget->ops || !widget->ops->on_time_tick) {
         return;
     }
 
+    if (!(changed & widget->time_mask)) {
+        return;
+    }
+
+    widget_begin_run(widget);
+    bool clipped = widget_begin_draw(widget);
     widget->ops->on_time_tick(widget, timeinfo);
+    widget_end_draw(widget, clipped);
+    widget_end_run(widget);
 }
 
 static inline void widget_update(Widget* widget) {
@@ -128,7 +341,11 @@ static inline void widget_update(Widget* widget) {
         return;
     }
 
+    widget_begin_run(widget);
+    bool clipped = widget_begin_draw(widget);
     widget->ops->on_update(widget);
+    widget_end_draw(widget, clipped);
+    widget_end_run(widget);
 }
 
 static inline void* widget_state(Widget* widget) {
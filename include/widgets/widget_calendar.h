@@ -35,6 +35,7 @@ typedef struct {
     int cached_month;
     int cached_year;
     bool dirty;
+    int redraw_step;    // Next slice of the redraw in progress, -1 when done
     int bounds_x;
     int bounds_y;
     int bounds_width;
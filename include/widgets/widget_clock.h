@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <time.h>
 
+#include "profile.h"
 #include "widget.h"
 
 typedef struct {
@@ -12,6 +13,8 @@ typedef struct {
     int radius;
     bool show_numbers;
     bool show_markers;
+    bool antialias;     // Wu hands blended through the theme ramps
+    bool sweep;         // Second and minute hands move every frame
     RotationAngle rotation;
 } ClockConfig;
 
@@ -23,25 +26,53 @@ typedef struct {
     u16 minute_hand;
     u16 second_hand;
     u16 marker;
+    // Hand colors over the background, for anti-aliased hands
+    GfxBlendRamp hour_ramp;
+    GfxBlendRamp minute_ramp;
+    GfxBlendRamp second_ramp;
+    GfxBlendRamp erase_ramp;
 } ClockTheme;
 
+// Instant shown by the hands. `millis` is the position within the second in
+// sweep mode and 0 otherwise; hour < 0 means no hands.
+typedef struct {
+    int hour;
+    int minute;
+    int second;
+    int millis;
+} ClockTime;
+
 typedef struct {
     ClockConfig config;
     ClockTheme light_theme;
     ClockTheme dark_theme;
     int last_second;
-    int drawn_hour;
-    int drawn_minute;
-    int drawn_second;
+    ClockTime time;     // Latest tick (hour < 0 before the first one)
+    ClockTime drawn;    // What the hands on screen show
+    int subsecond;      // Milliseconds into the current second, from the app
+    // Sweep redraws run every sweep_interval frames; the interval doubles
+    // while a redraw exceeds the widget's budget
+    int sweep_interval;
     bool face_dirty;
+    bool face_staged;   // The cache holds a new face not yet copied to the screen
     int bounds_x;
     int bounds_y;
     int bounds_width;
     int bounds_height;
+    // Surface-sized buffer holding the face without hands (NULL to erase
+    // and redraw the hands instead). Re-rendered whenever face_dirty is set.
+    u16* face_cache;
+    int face_cache_pixels;
+    ProfileCounter hands_time;  // Hand restore (or erase) + redraw per tick
+    ProfileCounter sweep_time;  // The same for sweep frames between ticks
 } ClockWidgetState;
 
 void widget_clock_init(Widget* widget, ClockWidgetState* state);
 ClockTheme* widget_clock_current_theme(ClockWidgetState* state, WidgetTheme theme);
 void widget_clock_set_bounds(ClockWidgetState* state, int x, int y, int width, int height);
+void widget_clock_set_antialias(ClockWidgetState* state, bool enabled);
+void widget_clock_set_sweep(ClockWidgetState* state, bool enabled);
+void widget_clock_set_subsecond(ClockWidgetState* state, int millis);
+void widget_clock_set_face_cache(ClockWidgetState* state, u16* buffer, int pixels);
 
 #endif // WIDGET_CLOCK_H
@@ -0,0 +1,62 @@
+#ifndef WIDGET_DIGITAL_CLOCK_H
+#define WIDGET_DIGITAL_CLOCK_H
+
+#include <stdbool.h>
+#include <time.h>
+
+#include "widget.h"
+
+// Longest time ("12:34:56") and date ("Wed 16 Oct 2026") strings
+#define DIGITAL_TIME_CHARS 8
+#define DIGITAL_DATE_CHARS 15
+
+typedef struct {
+    bool hour_24;       // 24-hour time; otherwise 12-hour with AM/PM
+    bool show_seconds;
+    bool show_date;     // Date line under the time
+    RotationAngle rotation;
+} DigitalClockConfig;
+
+typedef struct {
+    u16 background;
+    u16 border;
+    u16 segment;        // Lit segments and colon
+    u16 segment_off;    // Unlit segments, faint like an LCD
+    u16 text;           // AM/PM and date
+} DigitalClockTheme;
+
+// Row of fixed character cells; only cells whose character changed are
+// repainted. drawn[i] == '\0' means the cell is blank.
+typedef struct {
+    int x;
+    int y;
+    int count;
+    int cell_x[DIGITAL_DATE_CHARS];     // Left edge of each cell
+    int cell_width[DIGITAL_DATE_CHARS];
+    int cell_height;
+    char drawn[DIGITAL_DATE_CHARS + 1];
+} DigitalClockRow;
+
+typedef struct {
+    DigitalClockConfig config;
+    DigitalClockTheme light_theme;
+    DigitalClockTheme dark_theme;
+    int bounds_x;
+    int bounds_y;
+    int bounds_width;
+    int bounds_height;
+    // Layout, recomputed when the bounds or format change
+    int thickness;      // Segment thickness
+    DigitalClockRow time_row;
+    DigitalClockRow suffix_row;     // "AM"/"PM" in 12-hour mode
+    DigitalClockRow date_row;
+    bool dirty;         // Bounds, border and every cell need repainting
+    int cells_drawn;    // Cells repainted by the last tick
+} DigitalClockWidgetState;
+
+void widget_digital_clock_init(Widget* widget, DigitalClockWidgetState* state);
+void widget_digital_clock_set_bounds(DigitalClockWidgetState* state, int x, int y, int width, int height);
+void widget_digital_clock_set_format(DigitalClockWidgetState* state, bool hour_24, bool show_seconds,
+                                     bool show_date);
+
+#endif // WIDGET_DIGITAL_CLOCK_H
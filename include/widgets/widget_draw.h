@@ -35,6 +35,7 @@ typedef struct {
     u16 info_background_color;
     u16 text_color;
     u16 pen_color;
+    GfxBlendRamp clear_mark_ramp;   // Red 'X' over the info background
 } DrawWidgetState;
 
 void widget_draw_init(Widget* widget, DrawWidgetState* state);
@@ -0,0 +1,26 @@
+#ifndef WIDGET_SCHEDULER_H
+#define WIDGET_SCHEDULER_H
+
+#include "widget.h"
+
+// Runs on_update only for widgets with a pending wake source instead of
+// polling every widget every frame. App-wide events are latched with
+// widget_scheduler_signal (from interrupts too) and delivered to the
+// widgets subscribed to them; timers count frames per widget, and
+// widget_invalidate queues a single run. Time ticks stay with the time
+// service and each widget's time_mask.
+
+// Frame governor: true when the frame is running late, so low-priority
+// updates should wait
+typedef bool (*WidgetGovernor)(void* context);
+
+// Latch WIDGET_WAKE_TOUCH/WIDGET_WAKE_MIC events for the next run
+void widget_scheduler_signal(unsigned events);
+
+// Deliver the wake sources of `frames` elapsed frames and run on_update of
+// each widget that has one; returns how many ran. Widgets see what woke
+// them in wake_reasons. A low-priority widget keeps its wake sources for a
+// later frame while `governor` (may be NULL) reports the frame as late.
+int widget_scheduler_run(Widget* widgets, int count, int frames, WidgetGovernor governor, void* context);
+
+#endif // WIDGET_SCHEDULER_H
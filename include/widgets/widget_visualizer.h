@@ -15,6 +15,7 @@ typedef enum {
 typedef struct {
     GraphicsContext* ctx;
     bool mic_running;
+    bool mic_paused;            // Held off while the app is idle
     bool visible;
     bool force_redraw;
     bool layout_dirty;
@@ -29,9 +30,15 @@ typedef struct {
     int baseline;
     int max_height;
     int max_sample;
+    u32 max_sample_recip;       // geom_reciprocal(max_sample)
     int sample_rate;
     size_t mic_buffer_bytes;
     s16* mic_buffer;
+    // Sample reduction state, owned by the microphone interrupt
+    int reduce_samples;
+    int reduce_bars;
+    int reduce_chunk;
+    u32 reduce_chunk_recip;
     volatile bool frame_ready;
     volatile u16 target_heights[VISUALIZER_MAX_BARS];
     u16 pending_heights[VISUALIZER_MAX_BARS];
@@ -52,5 +59,6 @@ typedef struct {
 
 void widget_visualizer_init(Widget* widget, VisualizerWidgetState* state);
 void widget_visualizer_set_bounds(VisualizerWidgetState* state, int x, int y, int width, int height);
+void widget_visualizer_set_mic_paused(VisualizerWidgetState* state, bool paused);
 
 #endif // WIDGET_VISUALIZER_H
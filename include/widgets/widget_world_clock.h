@@ -0,0 +1,48 @@
+#ifndef WIDGET_WORLD_CLOCK_H
+#define WIDGET_WORLD_CLOCK_H
+
+#include <stdbool.h>
+#include <time.h>
+
+#include "tz.h"
+#include "widget.h"
+
+// One city of a world clock row. Any number of instances can share one UTC
+// reading: the owner updates it once per tick and each instance converts it
+// through tz.h, so the time is never read per instance.
+
+typedef enum {
+    WORLD_CLOCK_ANALOG,     // Small face with hour and minute hands
+    WORLD_CLOCK_DIGITAL     // "HH:MM"
+} WorldClockStyle;
+
+typedef struct {
+    u16 background;
+    u16 border;
+    u16 face;
+    u16 hands;
+    u16 text;           // Time and weekday
+    u16 label;          // City name
+} WorldClockTheme;
+
+typedef struct {
+    int zone;                   // tz.h zone index
+    WorldClockStyle style;
+    RotationAngle rotation;
+    const time_t* utc;          // Shared UTC reading, owned by the app
+    WorldClockTheme light_theme;
+    WorldClockTheme dark_theme;
+    int bounds_x;
+    int bounds_y;
+    int bounds_width;
+    int bounds_height;
+    TzTime drawn;               // Local time on screen
+    bool dirty;                 // Repaint on the next tick even if the minute is unchanged
+} WorldClockWidgetState;
+
+void widget_world_clock_init(Widget* widget, WorldClockWidgetState* state, int zone, const time_t* utc);
+void widget_world_clock_set_bounds(WorldClockWidgetState* state, int x, int y, int width, int height);
+void widget_world_clock_set_zone(WorldClockWidgetState* state, int zone);
+void widget_world_clock_set_style(WorldClockWidgetState* state, WorldClockStyle style);
+
+#endif // WIDGET_WORLD_CLOCK_H
@@ -0,0 +1,112 @@
+#include "color.h"
+
+// Red and blue of the low pixel plus green of the high one, each with at
+// least five spare bits above it: a channel times a weight <= 32, plus a
+// second such product, cannot carry into its neighbour. Swapping the
+// halves exposes the other three channels to the same mask.
+#define COLOR_SPREAD_MASK  0x03E07C1Fu
+#define COLOR_SPREAD_ROUND 0x02004010u  // Half a step (16) under each channel
+
+// Channels that sit five bits apart, for the saturating add: red + blue
+// of both pixels, and green of both pixels
+#define COLOR_RB_MASK      0x7C1F7C1Fu
+#define COLOR_RB_CARRY     0x80208020u
+#define COLOR_G_MASK       0x03E003E0u
+#define COLOR_G_CARRY      0x04000400u
+
+#define COLOR_CHANNEL_MASK 0x001F001Fu
+#define COLOR_ALPHA_BITS   0x80008000u
+
+static inline u32 color_swap(u32 pair) {
+    return (pair >> 16) | (pair << 16);
+}
+
+static inline int color_clamp_weight(int weight) {
+    if (weight < 0) return 0;
+    if (weight > COLOR_WEIGHT_MAX) return COLOR_WEIGHT_MAX;
+    return weight;
+}
+
+// round((a * wa + b * wb) / 32) for the three spread channels of a word
+static inline u32 color_weigh(u32 a, u32 b, u32 wa, u32 wb) {
+    u32 sum = (a & COLOR_SPREAD_MASK) * wa + (b & COLOR_SPREAD_MASK) * wb + COLOR_SPREAD_ROUND;
+    return (sum >> 5) & COLOR_SPREAD_MASK;
+}
+
+u32 color_lerp2(u32 a, u32 b, int weight) {
+    u32 wb = (u32)color_clamp_weight(weight);
+    u32 wa = COLOR_WEIGHT_MAX - wb;
+
+    u32 even = color_weigh(a, b, wa, wb);
+    u32 odd = color_weigh(color_swap(a), color_swap(b), wa, wb);
+    return even | color_swap(odd) | COLOR_ALPHA_BITS;
+}
+
+u32 color_add_sat2(u32 a, u32 b) {
+    // A channel that overflows sets the bit above it; turn that bit into
+    // an all-ones channel
+    u32 rb = (a & COLOR_RB_MASK) + (b & COLOR_RB_MASK);
+    u32 carry = rb & COLOR_RB_CARRY;
+    rb |= carry - (carry >> 5);
+
+    u32 g = (a & COLOR_G_MASK) + (b & COLOR_G_MASK);
+    carry = g & COLOR_G_CARRY;
+    g |= carry - (carry >> 5);
+
+    return (rb & COLOR_RB_MASK) | (g & COLOR_G_MASK) | COLOR_ALPHA_BITS;
+}
+
+u32 color_scale2(u32 color, int alpha) {
+    u32 weight = (u32)color_clamp_weight(alpha);
+    u32 even = color_weigh(0, color, 0, weight);
+    u32 odd = color_weigh(0, color_swap(color), 0, weight);
+    return even | color_swap(odd) | COLOR_ALPHA_BITS;
+}
+
+u32 color_gray2(u32 color) {
+    // Red, green and blue of both pixels in 16-bit lanes, weighted to a
+    // sum below 1024 per lane
+    u32 sum = (color & COLOR_CHANNEL_MASK) * 10 +
+              ((color >> 5) & COLOR_CHANNEL_MASK) * 19 +
+              ((color >> 10) & COLOR_CHANNEL_MASK) * 3 +
+              (16u * 0x10001u);
+    u32 luma = (sum >> 5) & COLOR_CHANNEL_MASK;
+    return (luma * 0x421u) | COLOR_ALPHA_BITS;
+}
+
+u16 color_lerp(u16 a, u16 b, int weight) {
+    return (u16)color_lerp2(a, b, weight);
+}
+
+u16 color_add_sat(u16 a, u16 b) {
+    return (u16)color_add_sat2(a, b);
+}
+
+u16 color_scale(u16 color, int alpha) {
+    return (u16)color_scale2(color, alpha);
+}
+
+u16 color_gray(u16 color) {
+    return (u16)color_gray2(color);
+}
+
+void color_gradient(u16* out, int count, u16 from, u16 to) {
+    if (!out || count <= 0) return;
+    if (count == 1) {
+        out[0] = (u16)(from | BIT(15));
+        return;
+    }
+
+    // Weights advance in 16.16 fixed point: one divide for the whole ramp.
+    // Entry i and its mirror count-1-i come from one lerp of swapped pairs.
+    u32 step = ((u32)COLOR_WEIGHT_MAX << 16) / (u32)(count - 1);
+    u32 weight = 1u << 15;
+    u32 forward = color_pack2(from, to);
+    u32 backward = color_pack2(to, from);
+
+    for (int i = 0, j = count - 1; i <= j; i++, j--, weight += step) {
+        u32 pair = color_lerp2(forward, backward, (int)(weight >> 16));
+        out[i] = (u16)pair;
+        out[j] = (u16)(pair >> 16);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef COLOR_H
+#define COLOR_H
+
+#include <nds.h>
+
+// Fixed-point RGB15 color math without per-channel divides. Weights run
+// from 0 to COLOR_WEIGHT_MAX in 1/32 steps, matching the 5-bit channels.
+//
+// The *2 functions work on two pixels packed in one word (the first in the
+// low half, the order two adjacent framebuffer pixels load in) and treat
+// both with one set of word operations. Results always have the alpha bit
+// set; single-pixel versions return the low half of the same code path.
+#define COLOR_WEIGHT_MAX 32
+
+static inline u32 color_pack2(u16 first, u16 second) {
+    return (u32)first | ((u32)second << 16);
+}
+
+// Per channel round(a + (b - a) * weight / 32); weight is clamped
+u32 color_lerp2(u32 a, u32 b, int weight);
+// Per channel min(a + b, 31)
+u32 color_add_sat2(u32 a, u32 b);
+// Per channel round(color * alpha / 32); alpha is clamped
+u32 color_scale2(u32 color, int alpha);
+// Luma (10/32 red, 19/32 green, 3/32 blue) copied to all three channels
+u32 color_gray2(u32 color);
+
+u16 color_lerp(u16 a, u16 b, int weight);
+u16 color_add_sat(u16 a, u16 b);
+u16 color_scale(u16 color, int alpha);
+u16 color_gray(u16 color);
+
+// Fill out[0..count) with evenly spaced colors from `from` to `to`, both
+// included. Entry i uses weight round(i * 32 / (count - 1)) and its mirror
+// entry the complementary one, so each lerp produces two entries.
+void color_gradient(u16* out, int count, u16 from, u16 to);
+
+#endif // COLOR_H
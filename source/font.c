@@ -0,0 +1,380 @@
+#include "font.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// 3x5 glyphs for ' ' through '`' plus '{' through '~', one row per byte
+// (bit 2 = leftmost pixel). Lower case letters fold to upper case.
+static const u8 font_tiny_data[][5] = {
+    {0x0, 0x0, 0x0, 0x0, 0x0}, // space
+    {0x2, 0x2, 0x2, 0x0, 0x2}, // !
+    {0x5, 0x5, 0x0, 0x0, 0x0}, // "
+    {0x5, 0x7, 0x5, 0x7, 0x5}, // #
+    {0x3, 0x6, 0x2, 0x3, 0x6}, // $
+    {0x5, 0x1, 0x2, 0x4, 0x5}, // %
+    {0x2, 0x5, 0x2, 0x5, 0x3}, // &
+    {0x2, 0x2, 0x0, 0x0, 0x0}, // '
+    {0x1, 0x2, 0x2, 0x2, 0x1}, // (
+    {0x4, 0x2, 0x2, 0x2, 0x4}, // )
+    {0x0, 0x5, 0x2, 0x5, 0x0}, // *
+    {0x0, 0x2, 0x7, 0x2, 0x0}, // +
+    {0x0, 0x0, 0x0, 0x2, 0x4}, // ,
+    {0x0, 0x0, 0x7, 0x0, 0x0}, // -
+    {0x0, 0x0, 0x0, 0x0, 0x2}, // .
+    {0x1, 0x1, 0x2, 0x4, 0x4}, // /
+    {0x7, 0x5, 0x5, 0x5, 0x7}, // 0
+    {0x2, 0x6, 0x2, 0x2, 0x7}, // 1
+    {0x7, 0x1, 0x7, 0x4, 0x7}, // 2
+    {0x7, 0x1, 0x7, 0x1, 0x7}, // 3
+    {0x5, 0x5, 0x7, 0x1, 0x1}, // 4
+    {0x7, 0x4, 0x7, 0x1, 0x7}, // 5
+    {0x7, 0x4, 0x7, 0x5, 0x7}, // 6
+    {0x7, 0x1, 0x1, 0x1, 0x1}, // 7
+    {0x7, 0x5, 0x7, 0x5, 0x7}, // 8
+    {0x7, 0x5, 0x7, 0x1, 0x7}, // 9
+    {0x0, 0x2, 0x0, 0x2, 0x0}, // :
+    {0x0, 0x2, 0x0, 0x2, 0x4}, // ;
+    {0x1, 0x2, 0x4, 0x2, 0x1}, // <
+    {0x0, 0x7, 0x0, 0x7, 0x0}, // =
+    {0x4, 0x2, 0x1, 0x2, 0x4}, // >
+    {0x7, 0x1, 0x2, 0x0, 0x2}, // ?
+    {0x2, 0x5, 0x7, 0x4, 0x3}, // @
+    {0x2, 0x5, 0x7, 0x5, 0x5}, // A
+    {0x6, 0x5, 0x6, 0x5, 0x6}, // B
+    {0x3, 0x4, 0x4, 0x4, 0x3}, // C
+    {0x6, 0x5, 0x5, 0x5, 0x6}, // D
+    {0x7, 0x4, 0x6, 0x4, 0x7}, // E
+    {0x7, 0x4, 0x6, 0x4, 0x4}, // F
+    {0x3, 0x4, 0x5, 0x5, 0x3}, // G
+    {0x5, 0x5, 0x7, 0x5, 0x5}, // H
+    {0x7, 0x2, 0x2, 0x2, 0x7}, // I
+    {0x1, 0x1, 0x1, 0x5, 0x2}, // J
+    {0x5, 0x5, 0x6, 0x5, 0x5}, // K
+    {0x4, 0x4, 0x4, 0x4, 0x7}, // L
+    {0x5, 0x7, 0x5, 0x5, 0x5}, // M
+    {0x6, 0x5, 0x5, 0x5, 0x5}, // N
+    {0x2, 0x5, 0x5, 0x5, 0x2}, // O
+    {0x6, 0x5, 0x6, 0x4, 0x4}, // P
+    {0x2, 0x5, 0x5, 0x6, 0x3}, // Q
+    {0x6, 0x5, 0x6, 0x5, 0x5}, // R
+    {0x7, 0x4, 0x7, 0x1, 0x7}, // S
+    {0x7, 0x2, 0x2, 0x2, 0x2}, // T
+    {0x5, 0x5, 0x5, 0x5, 0x7}, // U
+    {0x5, 0x5, 0x5, 0x5, 0x2}, // V
+    {0x5, 0x5, 0x5, 0x7, 0x5}, // W
+    {0x5, 0x5, 0x2, 0x5, 0x5}, // X
+    {0x5, 0x5, 0x2, 0x2, 0x2}, // Y
+    {0x7, 0x1, 0x2, 0x4, 0x7}, // Z
+    {0x3, 0x2, 0x2, 0x2, 0x3}, // [
+    {0x4, 0x4, 0x2, 0x1, 0x1}, // backslash
+    {0x6, 0x2, 0x2, 0x2, 0x6}, // ]
+    {0x2, 0x5, 0x0, 0x0, 0x0}, // ^
+    {0x0, 0x0, 0x0, 0x0, 0x7}, // _
+    {0x4, 0x2, 0x0, 0x0, 0x0}, // `
+    {0x3, 0x2, 0x6, 0x2, 0x3}, // {
+    {0x2, 0x2, 0x2, 0x2, 0x2}, // |
+    {0x6, 0x2, 0x3, 0x2, 0x6}, // }
+    {0x0, 0x3, 0x6, 0x0, 0x0}, // ~
+};
+
+// 5x7 glyphs for ' ' through '~', one column per byte (bit 0 = top row)
+static const u8 font_small_data[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, // space
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, // !
+    {0x00, 0x07, 0x00, 0x07, 0x00}, // "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // #
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // $
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // %
+    {0x36, 0x49, 0x55, 0x22, 0x50}, // &
+    {0x00, 0x05, 0x03, 0x00, 0x00}, // '
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, // (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, // )
+    {0x14, 0x08, 0x3E, 0x08, 0x14}, // *
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, // +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, // ,
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // -
+    {0x00, 0x60, 0x60, 0x00, 0x00}, // .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // /
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2
+    {0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
+    {0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
+    {0x00, 0x36, 0x36, 0x00, 0x00}, // :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, // ;
+    {0x08, 0x14, 0x22, 0x41, 0x00}, // <
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // >
+    {0x02, 0x01, 0x51, 0x09, 0x06}, // ?
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, // @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // A
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, // F
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, // G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, // J
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, // K
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, // L
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // M
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, // S
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, // T
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // W
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // X
+    {0x07, 0x08, 0x70, 0x08, 0x07}, // Y
+    {0x61, 0x51, 0x49, 0x45, 0x43}, // Z
+    {0x00, 0x7F, 0x41, 0x41, 0x00}, // [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, // backslash
+    {0x00, 0x41, 0x41, 0x7F, 0x00}, // ]
+    {0x04, 0x02, 0x01, 0x02, 0x04}, // ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, // _
+    {0x00, 0x01, 0x02, 0x04, 0x00}, // `
+    {0x20, 0x54, 0x54, 0x54, 0x78}, // a
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, // b
+    {0x38, 0x44, 0x44, 0x44, 0x20}, // c
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, // d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, // e
+    {0x08, 0x7E, 0x09, 0x01, 0x02}, // f
+    {0x0C, 0x52, 0x52, 0x52, 0x3E}, // g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, // h
+    {0x00, 0x44, 0x7D, 0x40, 0x00}, // i
+    {0x20, 0x40, 0x44, 0x3D, 0x00}, // j
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, // k
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, // l
+    {0x7C, 0x04, 0x18, 0x04, 0x78}, // m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, // n
+    {0x38, 0x44, 0x44, 0x44, 0x38}, // o
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, // p
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, // q
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, // r
+    {0x48, 0x54, 0x54, 0x54, 0x20}, // s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, // t
+    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
+    {0x44, 0x28, 0x10, 0x28, 0x44}, // x
+    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, // z
+    {0x00, 0x08, 0x36, 0x41, 0x00}, // {
+    {0x00, 0x00, 0x7F, 0x00, 0x00}, // |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, // }
+    {0x02, 0x01, 0x02, 0x04, 0x02}, // ~
+};
+
+// Glyph source: either table layout is read through font_face_pixel()
+typedef struct {
+    const u8 (*data)[5];
+    int width;
+    int height;
+    bool column_major;
+} FontFace;
+
+static const FontFace FONT_FACES[] = {
+    {font_tiny_data, 3, 5, false},
+    {font_small_data, 5, 7, true},
+};
+
+#define FONT_FACE_TINY  0
+#define FONT_FACE_SMALL 1
+#define FONT_FACE_COUNT 2
+
+// Size variants: which face, how much it is scaled, and the gap between glyphs
+typedef struct {
+    int face;
+    int scale;
+    int spacing;
+} FontSize;
+
+static const FontSize FONT_SIZES[FONT_COUNT] = {
+    [FONT_TINY] = {FONT_FACE_TINY, 1, 1},
+    [FONT_SMALL] = {FONT_FACE_SMALL, 1, 1},
+    [FONT_TINY_2X] = {FONT_FACE_TINY, 2, 1},
+    [FONT_SMALL_2X] = {FONT_FACE_SMALL, 2, 2},
+};
+
+#define FONT_FIRST_CHAR 32
+#define FONT_LAST_CHAR  126
+#define FONT_GLYPH_COUNT (FONT_LAST_CHAR - FONT_FIRST_CHAR + 1)
+
+// Solid rectangle of a glyph, in unscaled font pixels
+typedef struct {
+    u8 x;
+    u8 y;
+    u8 w;
+    u8 h;
+} FontRect;
+
+// Both faces bake to 861 rects; no glyph needs more than 11
+#define FONT_RECT_POOL 1024
+
+typedef struct {
+    u16 first;
+    u8 count;
+} FontGlyph;
+
+static FontRect font_rects[FONT_RECT_POOL];
+static FontGlyph font_glyphs[FONT_FACE_COUNT][FONT_GLYPH_COUNT];
+static int font_rect_count;
+static bool font_ready;
+
+// Table row for a character, or -1 when the face has no glyph for it
+static int font_face_index(int face, int ch) {
+    if (ch < FONT_FIRST_CHAR || ch > FONT_LAST_CHAR) return -1;
+    if (face != FONT_FACE_TINY) return ch - FONT_FIRST_CHAR;
+
+    if (ch >= 'a' && ch <= 'z') ch -= 'a' - 'A';
+    if (ch <= '`') return ch - FONT_FIRST_CHAR;
+    return ('`' - FONT_FIRST_CHAR + 1) + (ch - '{');
+}
+
+static bool font_face_pixel(const FontFace* face, int index, int x, int y) {
+    const u8* glyph = face->data[index];
+    if (face->column_major) {
+        return (glyph[x] >> y) & 1;
+    }
+    return (glyph[y] >> (face->width - 1 - x)) & 1;
+}
+
+// Split a glyph into horizontal runs and stack identical runs on
+// consecutive rows into one rectangle
+static void font_bake_glyph(int face_id, int ch) {
+    const FontFace* face = &FONT_FACES[face_id];
+    FontGlyph* glyph = &font_glyphs[face_id][ch - FONT_FIRST_CHAR];
+    glyph->first = (u16)font_rect_count;
+    glyph->count = 0;
+
+    int index = font_face_index(face_id, ch);
+    if (index < 0) return;
+
+    // Rects still open from the previous row
+    int open_first = font_rect_count;
+
+    for (int y = 0; y < face->height; y++) {
+        int row_first = font_rect_count;
+        int x = 0;
+        while (x < face->width) {
+            if (!font_face_pixel(face, index, x, y)) {
+                x++;
+                continue;
+            }
+            int start = x;
+            while (x < face->width && font_face_pixel(face, index, x, y)) x++;
+
+            bool extended = false;
+            for (int i = open_first; i < row_first; i++) {
+                FontRect* rect = &font_rects[i];
+                if (rect->x == start && rect->w == x - start && rect->y + rect->h == y) {
+                    rect->h++;
+                    extended = true;
+                    break;
+                }
+            }
+            if (extended || font_rect_count >= FONT_RECT_POOL) continue;
+
+            FontRect* rect = &font_rects[font_rect_count++];
+            rect->x = (u8)start;
+            rect->y = (u8)y;
+            rect->w = (u8)(x - start);
+            rect->h = 1;
+            glyph->count++;
+        }
+        // Only rects that reach this row can grow into the next one
+        while (open_first < row_first &&
+               font_rects[open_first].y + font_rects[open_first].h <= y) {
+            open_first++;
+        }
+    }
+}
+
+void font_init(void) {
+    if (font_ready) return;
+
+    font_rect_count = 0;
+    for (int face = 0; face < FONT_FACE_COUNT; face++) {
+        for (int ch = FONT_FIRST_CHAR; ch <= FONT_LAST_CHAR; ch++) {
+            font_bake_glyph(face, ch);
+        }
+    }
+    font_ready = true;
+}
+
+static int font_advance(const FontSize* size) {
+    return FONT_FACES[size->face].width * size->scale + size->spacing;
+}
+
+static int font_line_height(const FontSize* size) {
+    return FONT_FACES[size->face].height * size->scale + size->spacing;
+}
+
+int gfx_text_width(FontId font, const char* text) {
+    if (!text || font < 0 || font >= FONT_COUNT) return 0;
+
+    const FontSize* size = &FONT_SIZES[font];
+    int widest = 0;
+    int count = 0;
+    for (const char* p = text;; p++) {
+        if (*p == '\n' || *p == '\0') {
+            int width = count > 0 ? count * font_advance(size) - size->spacing : 0;
+            if (width > widest) widest = width;
+            if (*p == '\0') break;
+            count = 0;
+        } else {
+            count++;
+        }
+    }
+    return widest;
+}
+
+int gfx_text_height(FontId font, const char* text) {
+    if (!text || font < 0 || font >= FONT_COUNT) return 0;
+
+    const FontSize* size = &FONT_SIZES[font];
+    int lines = 1;
+    for (const char* p = text; *p; p++) {
+        if (*p == '\n') lines++;
+    }
+    return lines * font_line_height(size) - size->spacing;
+}
+
+void gfx_draw_text(GraphicsContext* ctx, int x, int y, const char* text, FontId font, u16 color) {
+    if (!ctx || !ctx->framebuffer || !text || font < 0 || font >= FONT_COUNT) return;
+    font_init();
+
+    const FontSize* size = &FONT_SIZES[font];
+    int scale = size->scale;
+    int pen_x = x;
+
+    for (const char* p = text; *p; p++) {
+        int ch = (unsigned char)*p;
+        if (ch == '\n') {
+            pen_x = x;
+            y += font_line_height(size);
+            continue;
+        }
+
+        if (ch >= FONT_FIRST_CHAR && ch <= FONT_LAST_CHAR) {
+            const FontGlyph* glyph = &font_glyphs[size->face][ch - FONT_FIRST_CHAR];
+            const FontRect* rect = &font_rects[glyph->first];
+            for (int i = 0; i < glyph->count; i++, rect++) {
+                gfx_draw_filled_rect(ctx, pen_x + rect->x * scale, y + rect->y * scale,
+                                     rect->w * scale, rect->h * scale, color);
+            }
+        }
+        pen_x += font_advance(size);
+    }
+}
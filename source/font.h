@@ -0,0 +1,28 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include "graphics.h"
+
+// Built-in bitmap fonts. Each face is baked once into rectangles of solid
+// pixels; scaled sizes reuse the same rectangles.
+typedef enum {
+    FONT_TINY,      // 3x5; lower case is drawn as upper case
+    FONT_SMALL,     // 5x7, full printable ASCII
+    FONT_TINY_2X,   // 3x5 doubled (6x10)
+    FONT_SMALL_2X,  // 5x7 doubled (10x14)
+    FONT_COUNT
+} FontId;
+
+// Bake the glyph rectangles (called lazily by the functions below)
+void font_init(void);
+
+// Size of a string in pixels; '\n' starts a new line
+int gfx_text_width(FontId font, const char* text);
+int gfx_text_height(FontId font, const char* text);
+
+// Draw a string with its top-left corner at logical (x, y). Glyphs are
+// filled as rectangles through the span path, not plotted per pixel.
+// Characters outside printable ASCII are skipped but still advance.
+void gfx_draw_text(GraphicsContext* ctx, int x, int y, const char* text, FontId font, u16 color);
+
+#endif // FONT_H
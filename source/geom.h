@@ -0,0 +1,154 @@
+#ifndef GEOM_H
+#define GEOM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef ARM9
+#include <nds.h>
+#endif
+
+// Integer geometry helpers. The ARM946E has no divide instruction, so a `/`
+// or `%` with a variable divisor is a libgcc call of ~40-100 cycles. On the
+// DS these helpers use the math coprocessor instead; elsewhere they fall
+// back to the C operators, so they run on a PC too.
+//
+// The coprocessor is shared state: call the geom_div*/geom_sqrt* helpers
+// from the main loop only, never from an interrupt handler (use the
+// reciprocal or DDA forms there). The *_start/*_result pairs let callers
+// do independent work while a result is computed (~36 cycles for a divide,
+// ~26 for a square root).
+
+#ifdef ARM9
+static inline void geom_div_start(int32_t num, int32_t den) {
+    REG_DIVCNT = DIV_32_32;
+    REG_DIV_NUMER_L = num;
+    REG_DIV_DENOM_L = den;
+}
+
+static inline int32_t geom_div_result(void) {
+    while (REG_DIVCNT & DIV_BUSY);
+    return REG_DIV_RESULT_L;
+}
+
+static inline int32_t geom_div_remainder(void) {
+    while (REG_DIVCNT & DIV_BUSY);
+    return REG_DIVREM_RESULT_L;
+}
+
+static inline void geom_sqrt_start(uint32_t value) {
+    REG_SQRTCNT = SQRT_32;
+    REG_SQRT_PARAM_L = value;
+}
+
+static inline uint32_t geom_sqrt_result(void) {
+    while (REG_SQRTCNT & SQRT_BUSY);
+    return REG_SQRT_RESULT;
+}
+#else
+static int32_t geom_div_quotient_value;
+static int32_t geom_div_remainder_value;
+static uint32_t geom_sqrt_value;
+
+static inline void geom_div_start(int32_t num, int32_t den) {
+    geom_div_quotient_value = num / den;
+    geom_div_remainder_value = num % den;
+}
+
+static inline int32_t geom_div_result(void) {
+    return geom_div_quotient_value;
+}
+
+static inline int32_t geom_div_remainder(void) {
+    return geom_div_remainder_value;
+}
+
+static inline void geom_sqrt_start(uint32_t value) {
+    uint32_t root = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+    }
+    geom_sqrt_value = root;
+}
+
+static inline uint32_t geom_sqrt_result(void) {
+    return geom_sqrt_value;
+}
+#endif
+
+// num / den, truncated toward zero like `/`
+static inline int32_t geom_div(int32_t num, int32_t den) {
+    geom_div_start(num, den);
+    return geom_div_result();
+}
+
+// Quotient and remainder of one division, as `/` and `%`
+static inline int32_t geom_divmod(int32_t num, int32_t den, int32_t* rem) {
+    geom_div_start(num, den);
+    int32_t quotient = geom_div_result();
+    *rem = geom_div_remainder();
+    return quotient;
+}
+
+// floor(sqrt(value))
+static inline uint32_t geom_sqrt(uint32_t value) {
+    geom_sqrt_start(value);
+    return geom_sqrt_result();
+}
+
+// Reciprocal for repeated division by the same den >= 1: ceil(2^31 / den).
+// geom_div_recip(num, geom_reciprocal(den)) == num / den exactly whenever
+// num * den < 2^31. Uses `/`, so it is safe to compute in an interrupt.
+static inline uint32_t geom_reciprocal(uint32_t den) {
+    return 0x7FFFFFFFu / den + 1;
+}
+
+static inline uint32_t geom_div_recip(uint32_t num, uint32_t recip) {
+    return (uint32_t)(((uint64_t)num * recip) >> 31);
+}
+
+// Integer DDA from (x0, y0) to (x1, y1) in max(|dx|, |dy|) steps. Point i
+// is (x0 + dx * i / steps, y0 + dy * i / steps) with `/` rounding toward
+// zero, produced without dividing.
+typedef struct {
+    int x, y;           // Current point
+    int dx, dy;         // Absolute deltas
+    int sx, sy;         // Direction of each axis (-1 or +1)
+    int steps;
+    int ex, ey;         // Accumulated remainders, in [0, steps)
+} GeomDda;
+
+// Start at (x0, y0) and return the number of steps to (x1, y1)
+static inline int geom_dda_init(GeomDda* dda, int x0, int y0, int x1, int y1) {
+    dda->x = x0;
+    dda->y = y0;
+    dda->dx = x1 >= x0 ? x1 - x0 : x0 - x1;
+    dda->dy = y1 >= y0 ? y1 - y0 : y0 - y1;
+    dda->sx = x1 >= x0 ? 1 : -1;
+    dda->sy = y1 >= y0 ? 1 : -1;
+    dda->steps = dda->dx > dda->dy ? dda->dx : dda->dy;
+    dda->ex = 0;
+    dda->ey = 0;
+    return dda->steps;
+}
+
+// Advance to the next point; each axis moves at most one pixel
+static inline void geom_dda_next(GeomDda* dda) {
+    dda->ex += dda->dx;
+    if (dda->ex >= dda->steps) {
+        dda->ex -= dda->steps;
+        dda->x += dda->sx;
+    }
+    dda->ey += dda->dy;
+    if (dda->ey >= dda->steps) {
+        dda->ey -= dda->steps;
+        dda->y += dda->sy;
+    }
+}
+
+#endif // GEOM_H
@@ -1,5 +1,564 @@
 #include "graphics.h"
+#include "color.h"
+#include "geom.h"
+#include "kernels.h"
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+// Spans shorter than this (in 32-bit words) are filled by the CPU; the DMA
+// setup cost only pays off for longer runs.
+#define GFX_DMA_FILL_MIN_WORDS 16
+
+// Polygon vertices are rasterized with this many fractional bits. Integer
+// coordinates are pixel centers; a pixel is filled when its center lies inside.
+#define GFX_SUBPIXEL_SHIFT 4
+#define GFX_SUBPIXEL_ONE   (1 << GFX_SUBPIXEL_SHIFT)
+
+// New damage within this many pixels of an existing rect is merged into it
+// rather than taking a new slot; per-pixel glyph plotting stays one rect.
+#define GFX_DAMAGE_MERGE_GAP 8
+
+static inline int gfx_min_int(int a, int b) { return a < b ? a : b; }
+static inline int gfx_max_int(int a, int b) { return a > b ? a : b; }
+
+// Division rounding toward negative infinity (d > 0); one divider pass
+// yields both the quotient and the remainder
+static inline int gfx_floor_div(int n, int d) {
+    int32_t r;
+    int q = geom_divmod(n, d, &r);
+    return r < 0 ? q - 1 : q;
+}
+
+// Display-list recording, defined at the end of this file
+static void gfx_record_fill(GraphicsContext* ctx, int x0, int y0, int x1, int y1, u16 color);
+static void gfx_record_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1, u16 color);
+static void gfx_record_copy(GraphicsContext* ctx, const u16* source, int x0, int y0, int x1, int y1);
+static void gfx_record_line_aa(GraphicsContext* ctx, int x0, int y0, int x1, int y1, int thickness,
+                               const GfxBlendRamp* ramp);
+
+static inline int gfx_rect_area(const GfxRect* r) {
+    return r->width * r->height;
+}
+
+static inline void gfx_rect_union(GfxRect* dst, const GfxRect* src) {
+    int x0 = gfx_min_int(dst->x, src->x);
+    int y0 = gfx_min_int(dst->y, src->y);
+    int x1 = gfx_max_int(dst->x + dst->width, src->x + src->width);
+    int y1 = gfx_max_int(dst->y + dst->height, src->y + src->height);
+    dst->x = x0;
+    dst->y = y0;
+    dst->width = x1 - x0;
+    dst->height = y1 - y0;
+}
+
+static inline bool gfx_rect_near(const GfxRect* a, const GfxRect* b, int gap) {
+    return a->x - gap <= b->x + b->width && b->x - gap <= a->x + a->width &&
+           a->y - gap <= b->y + b->height && b->y - gap <= a->y + a->height;
+}
+
+// Record a physical region as touched this frame (limited to the clip)
+void gfx_damage_add(GraphicsContext* ctx, int x, int y, int w, int h) {
+    if (!ctx) return;
+
+    const GfxRect* clip = &ctx->clip;
+    int x0 = gfx_max_int(x, clip->x);
+    int y0 = gfx_max_int(y, clip->y);
+    int x1 = gfx_min_int(x + w, clip->x + clip->width);
+    int y1 = gfx_min_int(y + h, clip->y + clip->height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    GfxRect rect = {x0, y0, x1 - x0, y1 - y0};
+
+    // Fast path: consecutive primitives usually land next to each other
+    if (ctx->damage_count > 0) {
+        GfxRect* last = &ctx->damage[ctx->damage_count - 1];
+        if (gfx_rect_near(last, &rect, GFX_DAMAGE_MERGE_GAP)) {
+            gfx_rect_union(last, &rect);
+            return;
+        }
+    }
+
+    for (int i = 0; i < ctx->damage_count - 1; i++) {
+        if (gfx_rect_near(&ctx->damage[i], &rect, GFX_DAMAGE_MERGE_GAP)) {
+            gfx_rect_union(&ctx->damage[i], &rect);
+            return;
+        }
+    }
+
+    if (ctx->damage_count < GFX_MAX_DAMAGE_RECTS) {
+        ctx->damage[ctx->damage_count++] = rect;
+        return;
+    }
+
+    // List is full: grow whichever rect absorbs the new one most cheaply
+    int best = 0;
+    int best_cost = 0;
+    for (int i = 0; i < ctx->damage_count; i++) {
+        GfxRect merged = ctx->damage[i];
+        gfx_rect_union(&merged, &rect);
+        int cost = gfx_rect_area(&merged) - gfx_rect_area(&ctx->damage[i]);
+        if (i == 0 || cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    gfx_rect_union(&ctx->damage[best], &rect);
+}
+
+static inline void gfx_damage_add_point(GraphicsContext* ctx, int x, int y) {
+    if (ctx->damage_count > 0) {
+        const GfxRect* last = &ctx->damage[ctx->damage_count - 1];
+        if (x >= last->x && x < last->x + last->width &&
+            y >= last->y && y < last->y + last->height) {
+            return;
+        }
+    }
+    gfx_damage_add(ctx, x, y, 1, 1);
+}
+
+// Number of damage rects recorded since the last gfx_damage_clear
+int gfx_damage_count(const GraphicsContext* ctx) {
+    return ctx ? ctx->damage_count : 0;
+}
+
+// Damage rect by index, in physical screen coordinates
+const GfxRect* gfx_damage_get(const GraphicsContext* ctx, int index) {
+    if (!ctx || index < 0 || index >= ctx->damage_count) return NULL;
+    return &ctx->damage[index];
+}
+
+// Bounding box of everything touched this frame
+bool gfx_damage_bounds(const GraphicsContext* ctx, GfxRect* out) {
+    if (!ctx || ctx->damage_count == 0) return false;
+
+    GfxRect bounds = ctx->damage[0];
+    for (int i = 1; i < ctx->damage_count; i++) {
+        gfx_rect_union(&bounds, &ctx->damage[i]);
+    }
+    if (out) *out = bounds;
+    return true;
+}
+
+// Check whether a physical region overlaps anything touched this frame
+bool gfx_damage_intersects(const GraphicsContext* ctx, int x, int y, int w, int h) {
+    if (!ctx) return false;
+    for (int i = 0; i < ctx->damage_count; i++) {
+        const GfxRect* r = &ctx->damage[i];
+        if (r->x < x + w && x < r->x + r->width && r->y < y + h && y < r->y + r->height) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Forget all recorded damage (call once the frame has been presented)
+void gfx_damage_clear(GraphicsContext* ctx) {
+    if (!ctx) return;
+    ctx->damage_count = 0;
+}
+
+// Copy a physical region between two of the context's surfaces with one DMA
+// per row. The region is widened to whole words so every transfer is 32-bit.
+static void gfx_copy_region(const GraphicsContext* ctx, u16* dst, const u16* src, const GfxRect* rect) {
+    int pitch = ctx->width;
+    int x0 = rect->x & ~1;
+    int x1 = (rect->x + rect->width + 1) & ~1;
+    if (x1 > pitch) x1 = pitch;
+    int y0 = rect->y;
+    int y1 = rect->y + rect->height;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    int offset = y0 * pitch + x0;
+
+    // Full-width rows are contiguous, so they collapse into a single transfer
+    if (x0 == 0 && x1 == pitch) {
+        dmaCopyWords(3, src + offset, dst + offset, (u32)((y1 - y0) * pitch) * 2);
+        return;
+    }
+
+    u32 row_bytes = (u32)(x1 - x0) * 2;
+    for (int y = y0; y < y1; y++) {
+        dmaCopyWords(3, src + offset, dst + offset, row_bytes);
+        offset += pitch;
+    }
+}
+
+// Start drawing into `back` while `front` is displayed
+void gfx_enable_double_buffer(GraphicsContext* ctx, u16* front, u16* back) {
+    if (!ctx || !front || !back) return;
+    gfx_execute_commands(ctx);
+    gfx_disable_shadow(ctx);
+
+    GfxRect screen = {0, 0, ctx->width, ctx->height};
+    gfx_copy_region(ctx, back, front, &screen);
+
+    ctx->framebuffer = back;
+    ctx->front_buffer = front;
+    ctx->present_pending = false;
+    ctx->present_count = 0;
+}
+
+// Go back to drawing straight into the displayed buffer
+void gfx_disable_double_buffer(GraphicsContext* ctx) {
+    if (!ctx || !ctx->front_buffer) return;
+    gfx_execute_commands(ctx);
+
+    ctx->framebuffer = ctx->front_buffer;
+    ctx->front_buffer = NULL;
+    ctx->present_pending = false;
+    ctx->present_count = 0;
+}
+
+// Render into a cached main-RAM surface (same size, 32-byte aligned) and
+// upload damage to the current framebuffer once per frame
+void gfx_enable_shadow(GraphicsContext* ctx, u16* shadow) {
+    if (!ctx || !shadow || !ctx->framebuffer || ctx->shadow_target) return;
+    gfx_execute_commands(ctx);
+    gfx_disable_double_buffer(ctx);
+
+    // CPU copy so the cache and RAM agree on the initial contents
+    memcpy(shadow, ctx->framebuffer, (size_t)ctx->width * ctx->height * sizeof(u16));
+
+    ctx->shadow_target = ctx->framebuffer;
+    ctx->framebuffer = shadow;
+    ctx->present_pending = false;
+    ctx->present_count = 0;
+}
+
+// Draw straight into VRAM again, uploading anything not yet presented
+void gfx_disable_shadow(GraphicsContext* ctx) {
+    if (!ctx || !ctx->shadow_target) return;
+
+    gfx_execute_commands(ctx);
+    gfx_queue_present(ctx);
+    gfx_upload_shadow(ctx);
+
+    ctx->framebuffer = ctx->shadow_target;
+    ctx->shadow_target = NULL;
+}
+
+// Latch this frame's damage for presentation. Returns false when there is
+// nothing to present or the context draws straight to the display.
+bool gfx_queue_present(GraphicsContext* ctx) {
+    if (!ctx || (!ctx->front_buffer && !ctx->shadow_target)) return false;
+    if (ctx->damage_count == 0) return false;
+
+    // Damage drawn while a presentation is still pending accumulates into it
+    if (!ctx->present_pending) {
+        ctx->present_count = 0;
+    }
+    for (int i = 0; i < ctx->damage_count; i++) {
+        if (ctx->present_count < GFX_MAX_DAMAGE_RECTS) {
+            ctx->present_damage[ctx->present_count++] = ctx->damage[i];
+        } else {
+            gfx_rect_union(&ctx->present_damage[GFX_MAX_DAMAGE_RECTS - 1], &ctx->damage[i]);
+        }
+    }
+
+    ctx->present_pending = true;
+    return true;
+}
+
+// Swap front and back. Call during VBlank, before any drawing for the frame.
+bool gfx_flip(GraphicsContext* ctx) {
+    if (!ctx || !ctx->front_buffer || !ctx->present_pending) return false;
+
+    u16* presented = ctx->framebuffer;
+    ctx->framebuffer = ctx->front_buffer;
+    ctx->front_buffer = presented;
+    ctx->present_pending = false;
+    return true;
+}
+
+// Bring the new back buffer up to date with what was just presented
+void gfx_sync_back_buffer(GraphicsContext* ctx) {
+    if (!ctx || !ctx->front_buffer) return;
+
+    for (int i = 0; i < ctx->present_count; i++) {
+        gfx_copy_region(ctx, ctx->framebuffer, ctx->front_buffer, &ctx->present_damage[i]);
+    }
+    ctx->present_count = 0;
+}
+
+// Copy the presented damage from the shadow surface to VRAM
+bool gfx_upload_shadow(GraphicsContext* ctx) {
+    if (!ctx || !ctx->shadow_target || !ctx->present_pending) return false;
+
+    for (int i = 0; i < ctx->present_count; i++) {
+        const GfxRect* rect = &ctx->present_damage[i];
+        // DMA reads RAM, not the cache: write the dirty lines back first
+        DC_FlushRange(ctx->framebuffer + rect->y * ctx->width,
+                      (u32)rect->height * ctx->width * sizeof(u16));
+        gfx_copy_region(ctx, ctx->shadow_target, ctx->framebuffer, rect);
+    }
+
+    ctx->present_count = 0;
+    ctx->present_pending = false;
+    return true;
+}
+
+// Whether a physical pixel lies inside the clip rect
+static inline bool gfx_in_clip(const GfxRect* clip, int x, int y) {
+    return (unsigned)(x - clip->x) < (unsigned)clip->width &&
+           (unsigned)(y - clip->y) < (unsigned)clip->height;
+}
+
+// Cohen-Sutherland region codes of a physical point against the clip rect
+#define GFX_OUT_LEFT   1
+#define GFX_OUT_RIGHT  2
+#define GFX_OUT_TOP    4
+#define GFX_OUT_BOTTOM 8
+
+static inline int gfx_outcode(const GfxRect* clip, int x, int y) {
+    int code = 0;
+    if (x < clip->x) code |= GFX_OUT_LEFT;
+    else if (x >= clip->x + clip->width) code |= GFX_OUT_RIGHT;
+    if (y < clip->y) code |= GFX_OUT_TOP;
+    else if (y >= clip->y + clip->height) code |= GFX_OUT_BOTTOM;
+    return code;
+}
+
+// Visible steps [*k0, *k1] of a Bresenham line from physical (px, py) to
+// (ex, ey). Each step moves one pixel along (major_x, major_y); after k
+// steps the line has also taken floor((2k * dmin + dmaj - 1) / (2 * dmaj))
+// steps along (minor_x, minor_y). Outcodes settle lines that are wholly
+// inside or outside; the rest are clipped by solving that closed form
+// against each clip edge, so no pixel needs testing later.
+static bool gfx_clip_line_steps(const GfxRect* clip, int px, int py, int ex, int ey,
+                                int major_x, int major_y, int minor_x, int minor_y,
+                                int dmaj, int dmin, int* k0, int* k1) {
+    int out0 = gfx_outcode(clip, px, py);
+    int out1 = gfx_outcode(clip, ex, ey);
+    if (out0 & out1) return false;
+
+    *k0 = 0;
+    *k1 = dmaj;
+    if ((out0 | out1) == 0) return true;
+
+    bool major_is_x = major_x != 0;
+    int m0 = major_is_x ? px : py;
+    int m_dir = major_is_x ? major_x : major_y;
+    int m_lo = major_is_x ? clip->x : clip->y;
+    int m_hi = m_lo + (major_is_x ? clip->width : clip->height) - 1;
+    int n0 = major_is_x ? py : px;
+    int n_dir = major_is_x ? minor_y : minor_x;
+    int n_lo = major_is_x ? clip->y : clip->x;
+    int n_hi = n_lo + (major_is_x ? clip->height : clip->width) - 1;
+
+    // Major axis: one pixel per step
+    if (m_dir > 0) {
+        *k0 = gfx_max_int(*k0, m_lo - m0);
+        *k1 = gfx_min_int(*k1, m_hi - m0);
+    } else {
+        *k0 = gfx_max_int(*k0, m0 - m_hi);
+        *k1 = gfx_min_int(*k1, m0 - m_lo);
+    }
+
+    // Minor axis: allowed offsets [lo, hi] from the start, along n_dir
+    int lo = n_dir > 0 ? n_lo - n0 : n0 - n_hi;
+    int hi = n_dir > 0 ? n_hi - n0 : n0 - n_lo;
+    if (dmin == 0) {
+        if (lo > 0 || hi < 0) return false;
+    } else {
+        *k0 = gfx_max_int(*k0, -gfx_floor_div(dmaj - 1 - 2 * dmaj * lo, 2 * dmin));
+        *k1 = gfx_min_int(*k1, gfx_floor_div(2 * dmaj * hi + dmaj, 2 * dmin));
+    }
+    return *k0 <= *k1;
+}
+
+// Rotation-specialized primitives. Each variant is generated from the
+// physical direction of one logical x step (XX, XY) and one logical y step
+// (YX, YY); these are compile-time constants, so every variant walks the
+// framebuffer with fixed increments instead of re-running the rotation math.
+#define GFX_ROT0_AXES   1,  0,  0,  1
+#define GFX_ROT90_AXES  0,  1, -1,  0
+#define GFX_ROT180_AXES -1, 0,  0, -1
+#define GFX_ROT270_AXES 0, -1,  1,  0
+
+#define GFX_DEFINE_ROTATION_VARIANTS(SUFFIX, AXES) \
+    GFX_DEFINE_ROTATION_VARIANTS_(SUFFIX, AXES)
+
+#define GFX_DEFINE_ROTATION_VARIANTS_(SUFFIX, XX, XY, YX, YY)                         \
+static inline void gfx_transform_##SUFFIX(const GraphicsContext* ctx, int x, int y,    \
+                                          int* out_x, int* out_y) {                    \
+    *out_x = ctx->origin_x + (XX) * x + (YX) * y;                                      \
+    *out_y = ctx->origin_y + (XY) * x + (YY) * y;                                      \
+}                                                                                      \
+                                                                                       \
+/* Write one pixel; the caller accounts for damage */                                 \
+static inline void gfx_put_##SUFFIX(GraphicsContext* ctx, int x, int y, u16 color) {   \
+    int px, py;                                                                        \
+    gfx_transform_##SUFFIX(ctx, x, y, &px, &py);                                       \
+    if (!gfx_in_clip(&ctx->clip, px, py)) return;                                      \
+    ctx->framebuffer[py * ctx->width + px] = color;                                    \
+}                                                                                      \
+                                                                                       \
+static inline void gfx_plot_##SUFFIX(GraphicsContext* ctx, int x, int y, u16 color) {  \
+    int px, py;                                                                        \
+    gfx_transform_##SUFFIX(ctx, x, y, &px, &py);                                       \
+    if (!gfx_in_clip(&ctx->clip, px, py)) return;                                      \
+    ctx->framebuffer[py * ctx->width + px] = color;                                    \
+    gfx_damage_add_point(ctx, px, py);                                                 \
+}                                                                                      \
+                                                                                       \
+static void gfx_draw_line_##SUFFIX(GraphicsContext* ctx, int x0, int y0,               \
+                                   int x1, int y1, u16 color) {                        \
+    int dx = abs(x1 - x0);                                                             \
+    int dy = abs(y1 - y0);                                                             \
+    int sx = x0 < x1 ? 1 : -1;                                                         \
+    int sy = y0 < y1 ? 1 : -1;                                                         \
+                                                                                       \
+    /* Physical position and framebuffer offset advance incrementally */               \
+    const int pitch = ctx->width;                                                      \
+    const int step_x_px = (XX) * sx, step_x_py = (XY) * sx;                            \
+    const int step_y_px = (YX) * sy, step_y_py = (YY) * sy;                            \
+    const int step_x_offset = step_x_px + step_x_py * pitch;                           \
+    const int step_y_offset = step_y_px + step_y_py * pitch;                           \
+                                                                                       \
+    /* Every iteration takes exactly one step along the major axis */                  \
+    bool x_major = dx >= dy;                                                           \
+    int dmaj = x_major ? dx : dy;                                                      \
+    int dmin = x_major ? dy : dx;                                                      \
+    int px, py, ex, ey, k0, k1;                                                        \
+    gfx_transform_##SUFFIX(ctx, x0, y0, &px, &py);                                     \
+    gfx_transform_##SUFFIX(ctx, x1, y1, &ex, &ey);                                     \
+    bool visible = x_major                                                             \
+        ? gfx_clip_line_steps(&ctx->clip, px, py, ex, ey, step_x_px, step_x_py,        \
+                              step_y_px, step_y_py, dmaj, dmin, &k0, &k1)              \
+        : gfx_clip_line_steps(&ctx->clip, px, py, ex, ey, step_y_px, step_y_py,        \
+                              step_x_px, step_x_py, dmaj, dmin, &k0, &k1);             \
+    if (!visible) return;                                                              \
+                                                                                       \
+    /* Jump to the first visible step; the error term follows from the step counts */  \
+    int minor0 = dmaj ? geom_div(2 * k0 * dmin + dmaj - 1, 2 * dmaj) : 0;              \
+    int minor1 = dmaj ? geom_div(2 * k1 * dmin + dmaj - 1, 2 * dmaj) : 0;              \
+    int nx0 = x_major ? k0 : minor0, ny0 = x_major ? minor0 : k0;                      \
+    int nx1 = x_major ? k1 : minor1, ny1 = x_major ? minor1 : k1;                      \
+    int err = dx - dy - nx0 * dy + ny0 * dx;                                           \
+    ex = px + nx1 * step_x_px + ny1 * step_y_px;                                       \
+    ey = py + nx1 * step_x_py + ny1 * step_y_py;                                       \
+    px += nx0 * step_x_px + ny0 * step_y_px;                                           \
+    py += nx0 * step_x_py + ny0 * step_y_py;                                           \
+    gfx_damage_add(ctx, gfx_min_int(px, ex), gfx_min_int(py, ey),                      \
+                   abs(ex - px) + 1, abs(ey - py) + 1);                                \
+                                                                                       \
+    u16* fb = ctx->framebuffer + py * pitch + px;                                      \
+    for (int k = k0;; k++) {                                                           \
+        *fb = color;                                                                   \
+        if (k == k1) break;                                                            \
+                                                                                       \
+        int e2 = 2 * err;                                                              \
+        if (e2 > -dy) {                                                                \
+            err -= dy;                                                                 \
+            fb += step_x_offset;                                                       \
+        }                                                                              \
+        if (e2 < dx) {                                                                 \
+            err += dx;                                                                 \
+            fb += step_y_offset;                                                       \
+        }                                                                              \
+    }                                                                                  \
+}                                                                                      \
+                                                                                       \
+/* Integer Wu line widened to a band of `thickness` pixels along the minor  */        \
+/* axis: a partially covered edge pixel, thickness - 1 solid pixels and the */        \
+/* complementary edge pixel per major step. One division per line. */                 \
+static void gfx_draw_thick_line_aa_##SUFFIX(GraphicsContext* ctx, int x0, int y0,      \
+                                            int x1, int y1, int thickness,             \
+                                            const GfxBlendRamp* ramp) {                \
+    bool steep = abs(y1 - y0) > abs(x1 - x0);                                          \
+    int t;                                                                             \
+    if (steep) {                                                                       \
+        t = x0; x0 = y0; y0 = t;                                                       \
+        t = x1; x1 = y1; y1 = t;                                                       \
+    }                                                                                  \
+    if (x0 > x1) {                                                                     \
+        t = x0; x0 = x1; x1 = t;                                                       \
+        t = y0; y0 = y1; y1 = t;                                                       \
+    }                                                                                  \
+                                                                                       \
+    int dx = x1 - x0;                                                                  \
+    int gradient = dx ? geom_div((y1 - y0) * 65536, dx) : 0;                           \
+    /* Top of the band in 16.16; pixel row r covers [r, r + 1) */                      \
+    int edge = y0 * 65536 + (1 << 15) - thickness * (1 << 15);                         \
+    u16 solid = ramp->shades[GFX_AA_LEVELS - 1];                                       \
+                                                                                       \
+    /* Damage: the logical bounding box grown by the band */                           \
+    int pad = thickness / 2 + 1;                                                       \
+    int ax, ay, bx, by;                                                                \
+    int lo = gfx_min_int(y0, y1) - pad, hi = gfx_max_int(y0, y1) + pad;                \
+    if (steep) {                                                                       \
+        gfx_transform_##SUFFIX(ctx, lo, x0, &ax, &ay);                                 \
+        gfx_transform_##SUFFIX(ctx, hi, x1, &bx, &by);                                 \
+    } else {                                                                           \
+        gfx_transform_##SUFFIX(ctx, x0, lo, &ax, &ay);                                 \
+        gfx_transform_##SUFFIX(ctx, x1, hi, &bx, &by);                                 \
+    }                                                                                  \
+    if (gfx_outcode(&ctx->clip, ax, ay) & gfx_outcode(&ctx->clip, bx, by)) return;     \
+    gfx_damage_add(ctx, gfx_min_int(ax, bx), gfx_min_int(ay, by),                      \
+                   abs(bx - ax) + 1, abs(by - ay) + 1);                                \
+                                                                                       \
+    for (int x = x0; x <= x1; x++, edge += gradient) {                                 \
+        int row = edge >> 16;                                                          \
+        int level = (edge & 0xFFFF) >> (16 - GFX_AA_SHIFT);                            \
+        u16 first = ramp->shades[GFX_AA_LEVELS - 1 - level];                           \
+        for (int k = 0; k < thickness; k++) {                                          \
+            u16 color = (k == 0) ? first : solid;                                      \
+            if (steep) gfx_put_##SUFFIX(ctx, row + k, x, color);                       \
+            else       gfx_put_##SUFFIX(ctx, x, row + k, color);                       \
+        }                                                                              \
+        if (level > 0) {                                                               \
+            if (steep) gfx_put_##SUFFIX(ctx, row + thickness, x, ramp->shades[level]);  \
+            else       gfx_put_##SUFFIX(ctx, x, row + thickness, ramp->shades[level]);  \
+        }                                                                              \
+    }                                                                                  \
+}
+
+GFX_DEFINE_ROTATION_VARIANTS(rot0, GFX_ROT0_AXES)
+GFX_DEFINE_ROTATION_VARIANTS(rot90, GFX_ROT90_AXES)
+GFX_DEFINE_ROTATION_VARIANTS(rot180, GFX_ROT180_AXES)
+GFX_DEFINE_ROTATION_VARIANTS(rot270, GFX_ROT270_AXES)
+
+// Recompute the origin and strides from rotation and pivot
+static void gfx_update_transform(GraphicsContext* ctx) {
+    int cx = ctx->pivot_x;
+    int cy = ctx->pivot_y;
+
+    switch (ctx->rotation) {
+        case ROTATION_90:
+            // 90° clockwise: (x, y) -> (-y, x) around the pivot
+            ctx->origin_x = cx + cy;
+            ctx->origin_y = cy - cx;
+            ctx->stride_x = ctx->width;
+            ctx->stride_y = -1;
+            break;
+
+        case ROTATION_180:
+            // 180°: (x, y) -> (-x, -y) around the pivot
+            ctx->origin_x = 2 * cx;
+            ctx->origin_y = 2 * cy;
+            ctx->stride_x = -1;
+            ctx->stride_y = -ctx->width;
+            break;
+
+        case ROTATION_270:
+            // 270° clockwise (90° counter-clockwise): (x, y) -> (y, -x) around the pivot
+            ctx->origin_x = cx - cy;
+            ctx->origin_y = cx + cy;
+            ctx->stride_x = -ctx->width;
+            ctx->stride_y = 1;
+            break;
+
+        case ROTATION_0:
+        default:
+            // No rotation; the pivot has no effect
+            ctx->origin_x = 0;
+            ctx->origin_y = 0;
+            ctx->stride_x = 1;
+            ctx->stride_y = ctx->width;
+            break;
+    }
+}
 
 // Initialize graphics context
 void gfx_init(GraphicsContext* ctx, u16* fb, int width, int height, RotationAngle rotation) {
@@ -9,17 +568,38 @@ void gfx_init(GraphicsContext* ctx, u16* fb, int width, int height, RotationAngl
     ctx->height = height;
     ctx->pivot_x = width / 2;
     ctx->pivot_y = height / 2;
+    ctx->damage_count = 0;
+    ctx->front_buffer = NULL;
+    ctx->shadow_target = NULL;
+    ctx->offscreen = false;
+    ctx->present_pending = false;
+    ctx->present_count = 0;
+    ctx->clip.x = 0;
+    ctx->clip.y = 0;
+    ctx->clip.width = width;
+    ctx->clip.height = height;
+    ctx->clip_depth = 0;
+    ctx->commands = NULL;
+    gfx_update_transform(ctx);
+}
+
+// Initialize a context over a cached main-RAM surface
+void gfx_init_offscreen(GraphicsContext* ctx, u16* buffer, int width, int height) {
+    gfx_init(ctx, buffer, width, height, ROTATION_0);
+    ctx->offscreen = true;
 }
 
 // Set rotation angle
 void gfx_set_rotation(GraphicsContext* ctx, RotationAngle rotation) {
     ctx->rotation = rotation;
+    gfx_update_transform(ctx);
 }
 
 // Set rotation pivot
 void gfx_set_pivot(GraphicsContext* ctx, int pivot_x, int pivot_y) {
     ctx->pivot_x = pivot_x;
     ctx->pivot_y = pivot_y;
+    gfx_update_transform(ctx);
 }
 
 // Convenience: update both rotation and pivot
@@ -27,135 +607,1272 @@ void gfx_set_transform(GraphicsContext* ctx, RotationAngle rotation, int pivot_x
     ctx->rotation = rotation;
     ctx->pivot_x = pivot_x;
     ctx->pivot_y = pivot_y;
+    gfx_update_transform(ctx);
+}
+
+// Limit drawing to the part of the current clip inside a physical rectangle.
+// Returns false (leaving the clip unchanged) when the stack is full.
+bool gfx_push_clip(GraphicsContext* ctx, int x, int y, int w, int h) {
+    if (!ctx || ctx->clip_depth >= GFX_MAX_CLIP_DEPTH) return false;
+
+    ctx->clip_stack[ctx->clip_depth++] = ctx->clip;
+
+    GfxRect* clip = &ctx->clip;
+    int x0 = gfx_max_int(x, clip->x);
+    int y0 = gfx_max_int(y, clip->y);
+    int x1 = gfx_min_int(x + w, clip->x + clip->width);
+    int y1 = gfx_min_int(y + h, clip->y + clip->height);
+    clip->x = x0;
+    clip->y = y0;
+    clip->width = gfx_max_int(x1 - x0, 0);
+    clip->height = gfx_max_int(y1 - y0, 0);
+    return true;
+}
+
+// Restore the clip in effect before the matching gfx_push_clip
+void gfx_pop_clip(GraphicsContext* ctx) {
+    if (!ctx || ctx->clip_depth == 0) return;
+    ctx->clip = ctx->clip_stack[--ctx->clip_depth];
+}
+
+// Map a logical point to physical framebuffer coordinates
+static inline void gfx_transform_point(const GraphicsContext* ctx, int x, int y, int* out_x, int* out_y) {
+    switch (ctx->rotation) {
+        case ROTATION_90:  gfx_transform_rot90(ctx, x, y, out_x, out_y); break;
+        case ROTATION_180: gfx_transform_rot180(ctx, x, y, out_x, out_y); break;
+        case ROTATION_270: gfx_transform_rot270(ctx, x, y, out_x, out_y); break;
+        default:           gfx_transform_rot0(ctx, x, y, out_x, out_y); break;
+    }
 }
 
 // Core pixel plotting with rotation transform
 void gfx_plot(GraphicsContext* ctx, int x, int y, u16 color) {
     if (!ctx->framebuffer) return;
-    
-    int final_x, final_y;
-    
-    // Rotation pivot
-    int cx = ctx->pivot_x;
-    int cy = ctx->pivot_y;
-    
-    // Translate to origin
-    int rel_x = x - cx;
-    int rel_y = y - cy;
-    
-    // Apply rotation around center
+
+    if (ctx->commands) {
+        int px, py;
+        gfx_transform_point(ctx, x, y, &px, &py);
+        if (gfx_in_clip(&ctx->clip, px, py)) {
+            gfx_record_fill(ctx, px, py, px + 1, py + 1, color);
+        }
+        return;
+    }
+
     switch (ctx->rotation) {
-        case ROTATION_0:
-            // No rotation
-            final_x = x;
-            final_y = y;
-            break;
-            
-        case ROTATION_90:
-            // 90° clockwise: (x, y) -> (-y, x)
-            final_x = -rel_y + cx;
-            final_y = rel_x + cy;
-            break;
-            
-        case ROTATION_180:
-            // 180°: (x, y) -> (-x, -y)
-            final_x = -rel_x + cx;
-            final_y = -rel_y + cy;
-            break;
-            
-        case ROTATION_270:
-            // 270° clockwise (90° counter-clockwise): (x, y) -> (y, -x)
-            final_x = rel_y + cx;
-            final_y = -rel_x + cy;
-            break;
-            
-        default:
-            final_x = x;
-            final_y = y;
-            break;
+        case ROTATION_90:  gfx_plot_rot90(ctx, x, y, color); break;
+        case ROTATION_180: gfx_plot_rot180(ctx, x, y, color); break;
+        case ROTATION_270: gfx_plot_rot270(ctx, x, y, color); break;
+        default:           gfx_plot_rot0(ctx, x, y, color); break;
+    }
+}
+
+// DMA writes bypass the data cache, so they may only target uncached VRAM
+static inline bool gfx_dma_allowed(const GraphicsContext* ctx) {
+    return ctx->shadow_target == NULL && !ctx->offscreen;
+}
+
+// Fill `count` consecutive halfwords with a color. Long spans in uncached
+// VRAM go to DMA (it bypasses the data cache); the rest use the fill kernel.
+static void gfx_fill_span16(u16* dst, int count, u16 color, bool allow_dma) {
+    if (count <= 0) return;
+
+    if (allow_dma && (count >> 1) >= GFX_DMA_FILL_MIN_WORDS) {
+        // Align to a word boundary so the bulk of the span is one transfer
+        if ((uintptr_t)dst & 2) {
+            *dst++ = color;
+            count--;
+        }
+        dmaFillWords((u32)color | ((u32)color << 16), dst, (u32)(count >> 1) << 2);
+        if (count & 1) {
+            dst[count - 1] = color;
+        }
+        return;
+    }
+
+    kernel_fill16(dst, color, count);
+}
+
+// Fill the physical rectangle [x0, x1) x [y0, y1), already within the
+// surface, and record its damage
+static void gfx_fill_clipped_rect(GraphicsContext* ctx, int x0, int y0, int x1, int y1, u16 color) {
+    gfx_damage_add(ctx, x0, y0, x1 - x0, y1 - y0);
+
+    int pitch = ctx->width;
+    u16* row = ctx->framebuffer + y0 * pitch + x0;
+    bool allow_dma = gfx_dma_allowed(ctx);
+
+    // Full-width rows are contiguous, so they collapse into a single span
+    if (x0 == 0 && x1 == pitch) {
+        gfx_fill_span16(row, (y1 - y0) * pitch, color, allow_dma);
+        return;
+    }
+
+    int span = x1 - x0;
+    for (int y = y0; y < y1; y++) {
+        gfx_fill_span16(row, span, color, allow_dma);
+        row += pitch;
+    }
+}
+
+// Copy `count` halfwords between surfaces at the same offset. Long spans go
+// to DMA like fills do; the source must already be flushed from the cache.
+static void gfx_copy_span16(u16* dst, const u16* src, int count, bool allow_dma) {
+    if (count <= 0) return;
+
+    if (allow_dma && (count >> 1) >= GFX_DMA_FILL_MIN_WORDS &&
+        (((uintptr_t)dst ^ (uintptr_t)src) & 2) == 0) {
+        if ((uintptr_t)dst & 2) {
+            *dst++ = *src++;
+            count--;
+        }
+        dmaCopyWords(3, src, dst, (u32)(count >> 1) << 2);
+        if (count & 1) {
+            dst[count - 1] = src[count - 1];
+        }
+        return;
+    }
+
+    kernel_copy16(dst, src, count);
+}
+
+// Copy the physical rectangle [x0, x1) x [y0, y1), already within the
+// surface, from a same-sized surface and record its damage
+static void gfx_copy_clipped_rect(GraphicsContext* ctx, const u16* source, int x0, int y0, int x1, int y1) {
+    gfx_damage_add(ctx, x0, y0, x1 - x0, y1 - y0);
+
+    int pitch = ctx->width;
+    int offset = y0 * pitch + x0;
+    bool allow_dma = gfx_dma_allowed(ctx);
+
+    if (x0 == 0 && x1 == pitch) {
+        gfx_copy_span16(ctx->framebuffer + offset, source + offset, (y1 - y0) * pitch, allow_dma);
+        return;
     }
-    
-    // Bounds check
-    if (final_x < 0 || final_x >= 256 || final_y < 0 || final_y >= 192) {
+
+    int span = x1 - x0;
+    for (int y = y0; y < y1; y++) {
+        gfx_copy_span16(ctx->framebuffer + offset, source + offset, span, allow_dma);
+        offset += pitch;
+    }
+}
+
+// Fill the physical rectangle [x0, x1) x [y0, y1), clipped to the clip rect
+static void gfx_fill_physical_rect(GraphicsContext* ctx, int x0, int y0, int x1, int y1, u16 color) {
+    const GfxRect* clip = &ctx->clip;
+    x0 = gfx_max_int(x0, clip->x);
+    y0 = gfx_max_int(y0, clip->y);
+    x1 = gfx_min_int(x1, clip->x + clip->width);
+    y1 = gfx_min_int(y1, clip->y + clip->height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    if (ctx->commands) {
+        gfx_record_fill(ctx, x0, y0, x1, y1, color);
         return;
     }
-    
-    ctx->framebuffer[final_y * 256 + final_x] = color;
+    gfx_fill_clipped_rect(ctx, x0, y0, x1, y1, color);
+}
+
+// Fill a logical rectangle. Quarter-turn rotations map axis-aligned rectangles
+// onto axis-aligned rectangles, so only the two corners need transforming.
+static void gfx_fill_logical_rect(GraphicsContext* ctx, int x, int y, int w, int h, u16 color) {
+    if (!ctx->framebuffer || w <= 0 || h <= 0) return;
+
+    int ax, ay, bx, by;
+    gfx_transform_point(ctx, x, y, &ax, &ay);
+    gfx_transform_point(ctx, x + w - 1, y + h - 1, &bx, &by);
+
+    int x0 = ax < bx ? ax : bx;
+    int x1 = ax < bx ? bx : ax;
+    int y0 = ay < by ? ay : by;
+    int y1 = ay < by ? by : ay;
+
+    gfx_fill_physical_rect(ctx, x0, y0, x1 + 1, y1 + 1, color);
+}
+
+// Map a subpixel logical point to subpixel physical coordinates. The
+// transform is a quarter-turn plus an integer origin, so only the origin
+// term needs scaling.
+static inline void gfx_transform_subpixel(const GraphicsContext* ctx, int x, int y, int* out_x, int* out_y) {
+    int px, py;
+    gfx_transform_point(ctx, x, y, &px, &py);
+    *out_x = px + ctx->origin_x * (GFX_SUBPIXEL_ONE - 1);
+    *out_y = py + ctx->origin_y * (GFX_SUBPIXEL_ONE - 1);
+}
+
+// Polygon edge over the rows whose pixel centers it spans. The crossing of
+// the current row is q + rem / den with 0 <= rem < den; a horizontal edge
+// (den == 0) covers [q, rem] on its single row instead.
+typedef struct {
+    int row0, row1;     // First and last row, already clipped
+    int q, rem, den;    // Current crossing
+    int q_step, rem_step;   // Per-row advance, same form
+} GfxPolygonEdge;
+
+// Set up `edge` from a to b (subpixel physical, a->y <= b->y) for rows
+// [row0, row1]. Returns false when it crosses none of them.
+static bool gfx_polygon_edge_init(GfxPolygonEdge* edge, const GfxPoint* a, const GfxPoint* b,
+                                  int row0, int row1) {
+    edge->row0 = gfx_max_int((a->y + GFX_SUBPIXEL_ONE - 1) >> GFX_SUBPIXEL_SHIFT, row0);
+    edge->row1 = gfx_min_int(b->y >> GFX_SUBPIXEL_SHIFT, row1);
+    if (edge->row0 > edge->row1) return false;
+
+    if (a->y == b->y) {
+        edge->q = (gfx_min_int(a->x, b->x) + GFX_SUBPIXEL_ONE - 1) >> GFX_SUBPIXEL_SHIFT;
+        edge->rem = gfx_max_int(a->x, b->x) >> GFX_SUBPIXEL_SHIFT;
+        edge->den = 0;
+        return true;
+    }
+
+    // x at row y is (a.x * dy + (y * ONE - a.y) * (b.x - a.x)) / (dy * ONE);
+    // both divisions are floored so the remainders stay non-negative
+    int dy = b->y - a->y;
+    int step = (b->x - a->x) << GFX_SUBPIXEL_SHIFT;
+    int num = a->x * dy + ((edge->row0 << GFX_SUBPIXEL_SHIFT) - a->y) * (b->x - a->x);
+    int32_t rem;
+    edge->den = dy << GFX_SUBPIXEL_SHIFT;
+    edge->q = geom_divmod(num, edge->den, &rem);
+    if (rem < 0) {
+        edge->q--;
+        rem += edge->den;
+    }
+    edge->rem = rem;
+    edge->q_step = geom_divmod(step, edge->den, &rem);
+    if (rem < 0) {
+        edge->q_step--;
+        rem += edge->den;
+    }
+    edge->rem_step = rem;
+    return true;
+}
+
+// Scanline fill of a convex polygon given in subpixel logical coordinates.
+// Each row is one span between the leftmost and rightmost edge crossings, so
+// every covered pixel is written exactly once. Crossings are exact: each edge
+// divides once to find its first row, then steps with a remainder, which
+// keeps the covered set identical under all four rotations.
+static void gfx_fill_convex_subpixel(GraphicsContext* ctx, const GfxPoint* points, int count, u16 color) {
+    if (!ctx->framebuffer || !points || count <= 0) return;
+    if (count > GFX_MAX_POLYGON_POINTS) count = GFX_MAX_POLYGON_POINTS;
+
+    GfxPoint v[GFX_MAX_POLYGON_POINTS];
+    int min_x, max_x, min_y, max_y;
+
+    for (int i = 0; i < count; i++) {
+        gfx_transform_subpixel(ctx, points[i].x, points[i].y, &v[i].x, &v[i].y);
+    }
+
+    min_x = max_x = v[0].x;
+    min_y = max_y = v[0].y;
+    for (int i = 1; i < count; i++) {
+        min_x = gfx_min_int(min_x, v[i].x);
+        max_x = gfx_max_int(max_x, v[i].x);
+        min_y = gfx_min_int(min_y, v[i].y);
+        max_y = gfx_max_int(max_y, v[i].y);
+    }
+
+    // Rows and columns whose pixel centers fall inside the bounds and the clip
+    const GfxRect* clip = &ctx->clip;
+    int row0 = gfx_max_int((min_y + GFX_SUBPIXEL_ONE - 1) >> GFX_SUBPIXEL_SHIFT, clip->y);
+    int row1 = gfx_min_int(max_y >> GFX_SUBPIXEL_SHIFT, clip->y + clip->height - 1);
+    int col0 = gfx_max_int((min_x + GFX_SUBPIXEL_ONE - 1) >> GFX_SUBPIXEL_SHIFT, clip->x);
+    int col1 = gfx_min_int(max_x >> GFX_SUBPIXEL_SHIFT, clip->x + clip->width - 1);
+    if (row0 > row1 || col0 > col1) return;
+
+    GfxPolygonEdge edges[GFX_MAX_POLYGON_POINTS];
+    int edge_count = 0;
+    for (int i = 0; i < count; i++) {
+        const GfxPoint* a = &v[i];
+        const GfxPoint* b = &v[i + 1 == count ? 0 : i + 1];
+        if (a->y > b->y) {
+            const GfxPoint* t = a;
+            a = b;
+            b = t;
+        }
+        if (gfx_polygon_edge_init(&edges[edge_count], a, b, row0, row1)) edge_count++;
+    }
+
+    // Recorded rows carry their own damage
+    if (!ctx->commands) {
+        gfx_damage_add(ctx, col0, row0, col1 - col0 + 1, row1 - row0 + 1);
+    }
+
+    int pitch = ctx->width;
+    u16* row = ctx->framebuffer + row0 * pitch;
+    bool allow_dma = gfx_dma_allowed(ctx);
+
+    for (int y = row0; y <= row1; y++, row += pitch) {
+        int x0 = col1 + 1;
+        int x1 = col0 - 1;
+
+        for (int i = 0; i < edge_count; i++) {
+            GfxPolygonEdge* edge = &edges[i];
+            if (y < edge->row0 || y > edge->row1) continue;
+
+            // First pixel center at or right of the crossing, last at or left of it
+            if (edge->den == 0) {
+                x0 = gfx_min_int(x0, edge->q);
+                x1 = gfx_max_int(x1, edge->rem);
+                continue;
+            }
+            x0 = gfx_min_int(x0, edge->rem > 0 ? edge->q + 1 : edge->q);
+            x1 = gfx_max_int(x1, edge->q);
+
+            edge->q += edge->q_step;
+            edge->rem += edge->rem_step;
+            if (edge->rem >= edge->den) {
+                edge->rem -= edge->den;
+                edge->q++;
+            }
+        }
+
+        x0 = gfx_max_int(x0, col0);
+        x1 = gfx_min_int(x1, col1);
+        if (x0 > x1) continue;
+        if (ctx->commands) {
+            gfx_record_fill(ctx, x0, y, x1 + 1, y + 1, color);
+        } else {
+            gfx_fill_span16(row + x0, x1 - x0 + 1, color, allow_dma);
+        }
+    }
+}
+
+// Fill a convex polygon (vertices in order, either winding)
+void gfx_fill_polygon(GraphicsContext* ctx, const GfxPoint* points, int count, u16 color) {
+    if (!ctx->framebuffer || !points || count <= 0) return;
+    if (count > GFX_MAX_POLYGON_POINTS) count = GFX_MAX_POLYGON_POINTS;
+
+    GfxPoint scaled[GFX_MAX_POLYGON_POINTS];
+    for (int i = 0; i < count; i++) {
+        scaled[i].x = points[i].x << GFX_SUBPIXEL_SHIFT;
+        scaled[i].y = points[i].y << GFX_SUBPIXEL_SHIFT;
+    }
+    gfx_fill_convex_subpixel(ctx, scaled, count, color);
+}
+
+// Fill a convex quadrilateral
+void gfx_fill_quad(GraphicsContext* ctx, int x0, int y0, int x1, int y1,
+                   int x2, int y2, int x3, int y3, u16 color) {
+    const GfxPoint points[4] = {{x0, y0}, {x1, y1}, {x2, y2}, {x3, y3}};
+    gfx_fill_polygon(ctx, points, 4, color);
 }
 
 // Bresenham line algorithm
 void gfx_draw_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1, u16 color) {
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-    int sx = x0 < x1 ? 1 : -1;
-    int sy = y0 < y1 ? 1 : -1;
-    int err = dx - dy;
+    if (!ctx->framebuffer) return;
+
+    if (ctx->commands) {
+        gfx_record_line(ctx, x0, y0, x1, y1, color);
+        return;
+    }
+
+    switch (ctx->rotation) {
+        case ROTATION_90:  gfx_draw_line_rot90(ctx, x0, y0, x1, y1, color); break;
+        case ROTATION_180: gfx_draw_line_rot180(ctx, x0, y0, x1, y1, color); break;
+        case ROTATION_270: gfx_draw_line_rot270(ctx, x0, y0, x1, y1, color); break;
+        default:           gfx_draw_line_rot0(ctx, x0, y0, x1, y1, color); break;
+    }
+}
+
+// Build the coverage ramp for drawing `foreground` over `background`
+void gfx_build_blend_ramp(GfxBlendRamp* ramp, u16 background, u16 foreground) {
+    if (!ramp) return;
+
+    int r0 = background & 0x1F;
+    int g0 = (background >> 5) & 0x1F;
+    int b0 = (background >> 10) & 0x1F;
+    int r1 = foreground & 0x1F;
+    int g1 = (foreground >> 5) & 0x1F;
+    int b1 = (foreground >> 10) & 0x1F;
+
+    const int steps = GFX_AA_LEVELS - 1;
+    for (int i = 0; i < GFX_AA_LEVELS; i++) {
+        // Weighted sums are non-negative, so rounding is the same in both
+        // directions; `steps` is odd, so there are no ties either
+        int r = (r0 * (steps - i) + r1 * i + steps / 2) / steps;
+        int g = (g0 * (steps - i) + g1 * i + steps / 2) / steps;
+        int b = (b0 * (steps - i) + b1 * i + steps / 2) / steps;
+        ramp->shades[i] = (u16)(RGB15(r, g, b) | BIT(15));
+    }
+    ramp->shades[0] = background;
+    ramp->shades[steps] = foreground;
+}
+
+// Anti-aliased line (Wu), one pixel wide
+void gfx_draw_line_aa(GraphicsContext* ctx, int x0, int y0, int x1, int y1, const GfxBlendRamp* ramp) {
+    gfx_draw_thick_line_aa(ctx, x0, y0, x1, y1, 1, ramp);
+}
+
+// Anti-aliased thick line: solid core with blended edges, no overdraw
+void gfx_draw_thick_line_aa(GraphicsContext* ctx, int x0, int y0, int x1, int y1, int thickness,
+                            const GfxBlendRamp* ramp) {
+    if (!ctx->framebuffer || !ramp || thickness <= 0) return;
+
+    if (ctx->commands) {
+        gfx_record_line_aa(ctx, x0, y0, x1, y1, thickness, ramp);
+        return;
+    }
+
+    switch (ctx->rotation) {
+        case ROTATION_90:  gfx_draw_thick_line_aa_rot90(ctx, x0, y0, x1, y1, thickness, ramp); break;
+        case ROTATION_180: gfx_draw_thick_line_aa_rot180(ctx, x0, y0, x1, y1, thickness, ramp); break;
+        case ROTATION_270: gfx_draw_thick_line_aa_rot270(ctx, x0, y0, x1, y1, thickness, ramp); break;
+        default:           gfx_draw_thick_line_aa_rot0(ctx, x0, y0, x1, y1, thickness, ramp); break;
+    }
+}
+
+// Thick line: a quad `thickness` pixels across with butt ends
+void gfx_draw_thick_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1, int thickness, u16 color) {
+    if (!ctx->framebuffer || thickness <= 0) return;
+    if (thickness == 1) {
+        gfx_draw_line(ctx, x0, y0, x1, y1, color);
+        return;
+    }
+
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    int length = (int)geom_sqrt((uint32_t)(dx * dx + dy * dy));
+    int half = thickness << (GFX_SUBPIXEL_SHIFT - 1);
+
+    if (length == 0) {
+        gfx_draw_filled_rect(ctx, x0 - thickness / 2, y0 - thickness / 2, thickness, thickness, color);
+        return;
+    }
+
+    // Half-width offset along the line normal, in subpixels; the endpoints
+    // are converted while the divider works
+    geom_div_start(-dy * half, length);
+    int sx0 = x0 << GFX_SUBPIXEL_SHIFT, sy0 = y0 << GFX_SUBPIXEL_SHIFT;
+    int sx1 = x1 << GFX_SUBPIXEL_SHIFT, sy1 = y1 << GFX_SUBPIXEL_SHIFT;
+    int nx = geom_div_result();
+    int ny = geom_div(dx * half, length);
+
+    const GfxPoint quad[4] = {
+        {sx0 + nx, sy0 + ny},
+        {sx1 + nx, sy1 + ny},
+        {sx1 - nx, sy1 - ny},
+        {sx0 - nx, sy0 - ny},
+    };
+    gfx_fill_convex_subpixel(ctx, quad, 4, color);
+}
+
+// Unit circle at 45° steps in Q12, for round caps
+static const int16_t gfx_cap_cos[8] = {4096, 2896, 0, -2896, -4096, -2896, 0, 2896};
+static const int16_t gfx_cap_sin[8] = {0, 2896, 4096, 2896, 0, -2896, -4096, -2896};
+
+// Append a half circle of subpixel radius `radius` around (cx, cy), from
+// angle step `first` through four 45° steps, relative to the unit
+// direction (ux, uy) in Q12
+static int gfx_append_cap(GfxPoint* out, int cx, int cy, int radius, int ux, int uy, int first) {
+    for (int i = 0; i <= 4; i++) {
+        int k = (first + i) & 7;
+        int c = gfx_cap_cos[k];
+        int s = gfx_cap_sin[k];
+        int ox = (c * ux - s * uy) >> 12;
+        int oy = (c * uy + s * ux) >> 12;
+        out[i].x = cx + ((radius * ox) >> 12);
+        out[i].y = cy + ((radius * oy) >> 12);
+    }
+    return 5;
+}
+
+// Line that narrows from start_width to end_width with round caps at both
+// ends, filled as a single convex polygon
+void gfx_draw_tapered_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1,
+                           int start_width, int end_width, u16 color) {
+    if (!ctx->framebuffer) return;
+    if (start_width <= 0 && end_width <= 0) return;
+
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    int length = (int)geom_sqrt((uint32_t)(dx * dx + dy * dy));
+
+    // Direction in Q12; a zero-length line still draws the larger cap
+    int ux = length ? geom_div(dx << 12, length) : (1 << 12);
+    int uy = length ? geom_div(dy << 12, length) : 0;
+
+    int r0 = gfx_max_int(start_width, 0) << (GFX_SUBPIXEL_SHIFT - 1);
+    int r1 = gfx_max_int(end_width, 0) << (GFX_SUBPIXEL_SHIFT - 1);
+
+    GfxPoint outline[10];
+    int count = 0;
+    // Tip cap from -90° to +90°, then base cap from +90° to +270°
+    count += gfx_append_cap(&outline[count], x1 << GFX_SUBPIXEL_SHIFT, y1 << GFX_SUBPIXEL_SHIFT,
+                            r1, ux, uy, 6);
+    count += gfx_append_cap(&outline[count], x0 << GFX_SUBPIXEL_SHIFT, y0 << GFX_SUBPIXEL_SHIFT,
+                            r0, ux, uy, 2);
+    gfx_fill_convex_subpixel(ctx, outline, count, color);
+}
+
+// Half-line bound used by arc clipping; well beyond any radius
+#define GFX_SPAN_UNBOUNDED (1 << 20)
 
-    while (1) {
-        gfx_plot(ctx, x0, y0, color);
+// Allowed x range [lo, hi] on one row, relative to the circle center
+typedef struct {
+    int lo;
+    int hi;
+} GfxSpanRange;
 
-        if (x0 == x1 && y0 == y1) break;
+// Arc sector in physical space: start and end directions in Q12
+typedef struct {
+    int start_x, start_y;
+    int end_x, end_y;
+    bool wide;      // Sweep over 180°: union of the half-planes, else intersection
+} GfxArcClip;
 
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
+// Fill physical row y over [x0, x1], clipped to the clip rect; the caller
+// accounts for damage unless the span is recorded
+static void gfx_fill_physical_span(GraphicsContext* ctx, int y, int x0, int x1, u16 color) {
+    const GfxRect* clip = &ctx->clip;
+    if ((unsigned)(y - clip->y) >= (unsigned)clip->height) return;
+    x0 = gfx_max_int(x0, clip->x);
+    x1 = gfx_min_int(x1, clip->x + clip->width - 1);
+    if (x0 > x1) return;
+    if (ctx->commands) {
+        gfx_record_fill(ctx, x0, y, x1 + 1, y + 1, color);
+        return;
+    }
+    gfx_fill_span16(ctx->framebuffer + y * ctx->width + x0, x1 - x0 + 1, color,
+                    gfx_dma_allowed(ctx));
+}
+
+// Row range where a * x <= b holds
+static GfxSpanRange gfx_half_plane_range(int a, int b) {
+    GfxSpanRange range = {-GFX_SPAN_UNBOUNDED, GFX_SPAN_UNBOUNDED};
+    if (a > 0) {
+        range.hi = gfx_floor_div(b, a);
+    } else if (a < 0) {
+        range.lo = -gfx_floor_div(b, -a);
+    } else if (b < 0) {
+        range.lo = GFX_SPAN_UNBOUNDED;
+        range.hi = -GFX_SPAN_UNBOUNDED;
+    }
+    return range;
+}
+
+// Allowed x ranges of the arc sector on row dy; returns how many (0..2)
+static int gfx_arc_row_ranges(const GfxArcClip* arc, int dy, GfxSpanRange* out) {
+    // Clockwise of the start direction, and counter-clockwise of the end
+    GfxSpanRange after_start = gfx_half_plane_range(arc->start_y, arc->start_x * dy);
+    GfxSpanRange before_end = gfx_half_plane_range(-arc->end_y, -arc->end_x * dy);
+
+    if (!arc->wide) {
+        out[0].lo = gfx_max_int(after_start.lo, before_end.lo);
+        out[0].hi = gfx_min_int(after_start.hi, before_end.hi);
+        return out[0].lo <= out[0].hi ? 1 : 0;
+    }
+
+    int count = 0;
+    if (after_start.lo <= after_start.hi) out[count++] = after_start;
+    if (before_end.lo <= before_end.hi) out[count++] = before_end;
+    if (count == 2) {
+        if (out[1].lo < out[0].lo) {
+            GfxSpanRange t = out[0];
+            out[0] = out[1];
+            out[1] = t;
         }
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
+        // Overlapping halves become one range so no pixel is filled twice
+        if (out[1].lo <= out[0].hi + 1) {
+            out[0].hi = gfx_max_int(out[0].hi, out[1].hi);
+            count = 1;
         }
     }
+    return count;
 }
 
-// Thick line (draw multiple parallel lines)
-void gfx_draw_thick_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1, int thickness, u16 color) {
-    for (int t = -thickness/2; t <= thickness/2; t++) {
-        gfx_draw_line(ctx, x0 + t, y0, x1 + t, y1, color);
-        gfx_draw_line(ctx, x0, y0 + t, x1, y1 + t, color);
+// Fill [x0, x1] on physical row y (relative to pcx), limited to the arc
+static void gfx_fill_arc_span(GraphicsContext* ctx, int pcx, int y, int dy, int x0, int x1,
+                              const GfxArcClip* arc, u16 color) {
+    if (x0 > x1) return;
+    if (!arc) {
+        gfx_fill_physical_span(ctx, y, pcx + x0, pcx + x1, color);
+        return;
+    }
+
+    GfxSpanRange ranges[2];
+    int count = gfx_arc_row_ranges(arc, dy, ranges);
+    for (int i = 0; i < count; i++) {
+        int lo = gfx_max_int(x0, ranges[i].lo);
+        int hi = gfx_min_int(x1, ranges[i].hi);
+        if (lo <= hi) {
+            gfx_fill_physical_span(ctx, y, pcx + lo, pcx + hi, color);
+        }
     }
 }
 
-// Draw rectangle outline
-void gfx_draw_rect(GraphicsContext* ctx, int x, int y, int w, int h, int thickness, u16 color) {
-    // Top and bottom
-    for (int t = 0; t < thickness; t++) {
-        for (int dx = 0; dx < w; dx++) {
-            gfx_plot(ctx, x + dx, y + t, color);
-            gfx_plot(ctx, x + dx, y + h - 1 - t, color);
+// Shrink *x until (x, dy) lies inside the midpoint disc of the given radius
+// (x^2 + dy^2 <= r^2 + r, i.e. within r + 1/2 of the center). Rows are
+// visited outward from the center, so the walk is O(radius) per disc.
+static inline int gfx_disc_half_width(int* x, int dy, int radius) {
+    int limit = radius * radius + radius - dy * dy;
+    while (*x >= 0 && *x * *x > limit) (*x)--;
+    return *x;
+}
+
+// Fill the pixels within `outer` of a logical center and outside the disc of
+// radius `inner` (inner < 0 for a solid disc), optionally limited to an arc.
+// Circles are symmetric under quarter turns, so the center is transformed
+// once and everything else is drawn as horizontal physical spans.
+static void gfx_fill_annulus(GraphicsContext* ctx, int cx, int cy, int outer, int inner,
+                             const GfxArcClip* arc, u16 color) {
+    if (!ctx->framebuffer || outer < 0) return;
+
+    int pcx, pcy;
+    gfx_transform_point(ctx, cx, cy, &pcx, &pcy);
+    if (gfx_outcode(&ctx->clip, pcx - outer, pcy - outer) &
+        gfx_outcode(&ctx->clip, pcx + outer, pcy + outer)) {
+        return;
+    }
+    if (!ctx->commands) {
+        gfx_damage_add(ctx, pcx - outer, pcy - outer, outer * 2 + 1, outer * 2 + 1);
+    }
+
+    int outer_x = outer;
+    int inner_x = inner;
+    for (int dy = 0; dy <= outer; dy++) {
+        int hw = gfx_disc_half_width(&outer_x, dy, outer);
+        int hole = (inner >= 0 && dy <= inner) ? gfx_disc_half_width(&inner_x, dy, inner) : -1;
+
+        for (int side = 0; side < 2; side++) {
+            int row_dy = side ? dy : -dy;
+            if (side && dy == 0) break;
+            int y = pcy + row_dy;
+            if ((unsigned)(y - ctx->clip.y) >= (unsigned)ctx->clip.height) continue;
+
+            if (hole < 0) {
+                gfx_fill_arc_span(ctx, pcx, y, row_dy, -hw, hw, arc, color);
+            } else {
+                gfx_fill_arc_span(ctx, pcx, y, row_dy, -hw, -hole - 1, arc, color);
+                gfx_fill_arc_span(ctx, pcx, y, row_dy, hole + 1, hw, arc, color);
+            }
         }
     }
-    // Left and right
-    for (int t = 0; t < thickness; t++) {
-        for (int dy = 0; dy < h; dy++) {
-            gfx_plot(ctx, x + t, y + dy, color);
-            gfx_plot(ctx, x + w - 1 - t, y + dy, color);
+}
+
+// Unit direction in Q12 of a physical angle, degrees clockwise from 12 o'clock
+static void gfx_angle_direction(int degrees, int* out_x, int* out_y) {
+    degrees %= 360;
+    if (degrees < 0) degrees += 360;
+    s16 angle = (s16)degreesToAngle(degrees);
+    *out_x = sinLerp(angle);
+    *out_y = -cosLerp(angle);
+}
+
+// Filled disc
+void gfx_fill_disc(GraphicsContext* ctx, int cx, int cy, int radius, u16 color) {
+    gfx_fill_annulus(ctx, cx, cy, radius, -1, NULL, color);
+}
+
+// Ring `thickness` pixels wide whose outer edge is `radius`
+void gfx_draw_ring(GraphicsContext* ctx, int cx, int cy, int radius, int thickness, u16 color) {
+    if (thickness <= 0) return;
+    gfx_fill_annulus(ctx, cx, cy, radius, radius - thickness, NULL, color);
+}
+
+// One-pixel circle outline
+void gfx_draw_circle(GraphicsContext* ctx, int cx, int cy, int radius, u16 color) {
+    gfx_draw_ring(ctx, cx, cy, radius, 1, color);
+}
+
+// Part of a ring from `start` sweeping `sweep` degrees clockwise (0 = 12 o'clock)
+void gfx_draw_arc(GraphicsContext* ctx, int cx, int cy, int radius, int thickness,
+                  int start, int sweep, u16 color) {
+    if (thickness <= 0 || sweep <= 0) return;
+    if (sweep >= 360) {
+        gfx_draw_ring(ctx, cx, cy, radius, thickness, color);
+        return;
+    }
+
+    // Logical angles turn with the context
+    int turn = (int)ctx->rotation * 90;
+    GfxArcClip arc;
+    gfx_angle_direction(start + turn, &arc.start_x, &arc.start_y);
+    gfx_angle_direction(start + sweep + turn, &arc.end_x, &arc.end_y);
+    arc.wide = sweep > 180;
+
+    gfx_fill_annulus(ctx, cx, cy, radius, radius - thickness, &arc, color);
+}
+
+// Blit source: one of an RGB15 image or a 1bpp mask (MSB = leftmost pixel)
+typedef enum {
+    GFX_BLIT_OPAQUE,
+    GFX_BLIT_COLORKEY,
+    GFX_BLIT_MASK
+} GfxBlitMode;
+
+typedef struct {
+    GfxBlitMode mode;
+    const u16* pixels;
+    const u8* bits;
+    int stride;     // Pixels (RGB15) or bytes (mask) per source row
+    u16 key;        // Colorkey: source pixels of this value are skipped
+    u16 fg;         // Mask: color of set bits
+    u16 bg;         // Mask: color of clear bits, or GFX_COLOR_NONE to skip
+} GfxBlitSource;
+
+static void gfx_record_blit(GraphicsContext* ctx, int x, int y, int w, int h, const GfxBlitSource* src);
+
+// Write source columns [i0, i1) of one row; `step` is the framebuffer
+// offset of one logical x step
+static void gfx_blit_row(u16* dst, int step, const GfxBlitSource* src, int row, int i0, int i1) {
+    switch (src->mode) {
+        case GFX_BLIT_OPAQUE: {
+            const u16* in = src->pixels + row * src->stride;
+            if (step == 1) {
+                kernel_copy16(dst, in + i0, i1 - i0);
+                break;
+            }
+            for (int i = i0; i < i1; i++, dst += step) {
+                *dst = in[i];
+            }
+            break;
+        }
+
+        case GFX_BLIT_COLORKEY: {
+            const u16* in = src->pixels + row * src->stride;
+            if (step == 1) {
+                kernel_copy16_colorkey(dst, in + i0, i1 - i0, src->key);
+                break;
+            }
+            for (int i = i0; i < i1; i++, dst += step) {
+                u16 color = in[i];
+                if (color != src->key) *dst = color;
+            }
+            break;
+        }
+
+        case GFX_BLIT_MASK: {
+            const u8* in = src->bits + row * src->stride;
+            bool fill_bg = src->bg != GFX_COLOR_NONE;
+            for (int i = i0; i < i1; i++, dst += step) {
+                if (in[i >> 3] & (0x80 >> (i & 7))) {
+                    *dst = src->fg;
+                } else if (fill_bg) {
+                    *dst = src->bg;
+                }
+            }
+            break;
+        }
+    }
+}
+
+// Columns [*i0, *i1) of a run that starts at physical coordinate `start`,
+// moves by `dir` (+1/-1) per column and must stay within [lo, hi)
+static void gfx_clip_run(int start, int dir, int lo, int hi, int width, int* i0, int* i1) {
+    if (dir > 0) {
+        *i0 = gfx_max_int(0, lo - start);
+        *i1 = gfx_min_int(width, hi - start);
+    } else {
+        *i0 = gfx_max_int(0, start - hi + 1);
+        *i1 = gfx_min_int(width, start - lo + 1);
+    }
+}
+
+// Place a w x h source at logical (x, y). Each source row is one physical
+// row (ROTATION_0/180) or column (90/270); it is clipped once and then
+// written with a fixed framebuffer step.
+static void gfx_blit_source(GraphicsContext* ctx, int x, int y, int w, int h, const GfxBlitSource* src) {
+    if (!ctx->framebuffer || w <= 0 || h <= 0) return;
+
+    int ax, ay, bx, by;
+    gfx_transform_point(ctx, x, y, &ax, &ay);
+    gfx_transform_point(ctx, x + w - 1, y + h - 1, &bx, &by);
+    if (gfx_outcode(&ctx->clip, ax, ay) & gfx_outcode(&ctx->clip, bx, by)) return;
+
+    if (ctx->commands) {
+        gfx_record_blit(ctx, x, y, w, h, src);
+        return;
+    }
+    gfx_damage_add(ctx, gfx_min_int(ax, bx), gfx_min_int(ay, by), abs(bx - ax) + 1, abs(by - ay) + 1);
+
+    int step = ctx->stride_x;
+    bool horizontal = step == 1 || step == -1;
+    int dir = horizontal ? step : step / ctx->width;
+    const GfxRect* clip = &ctx->clip;
+
+    for (int row = 0; row < h; row++) {
+        int px, py;
+        gfx_transform_point(ctx, x, y + row, &px, &py);
+
+        int i0, i1;
+        if (horizontal) {
+            if ((unsigned)(py - clip->y) >= (unsigned)clip->height) continue;
+            gfx_clip_run(px, dir, clip->x, clip->x + clip->width, w, &i0, &i1);
+        } else {
+            if ((unsigned)(px - clip->x) >= (unsigned)clip->width) continue;
+            gfx_clip_run(py, dir, clip->y, clip->y + clip->height, w, &i0, &i1);
         }
+        if (i0 >= i1) continue;
+
+        u16* dst = ctx->framebuffer + py * ctx->width + px + i0 * step;
+        gfx_blit_row(dst, step, src, row, i0, i1);
     }
 }
 
+// Copy an RGB15 image
+void gfx_blit(GraphicsContext* ctx, int x, int y, const u16* pixels, int w, int h, int stride) {
+    if (!pixels) return;
+    GfxBlitSource src = {.mode = GFX_BLIT_OPAQUE, .pixels = pixels, .stride = stride};
+    gfx_blit_source(ctx, x, y, w, h, &src);
+}
+
+// Copy an RGB15 image, skipping pixels equal to `key`
+void gfx_blit_colorkey(GraphicsContext* ctx, int x, int y, const u16* pixels, int w, int h, int stride,
+                       u16 key) {
+    if (!pixels) return;
+    GfxBlitSource src = {.mode = GFX_BLIT_COLORKEY, .pixels = pixels, .stride = stride, .key = key};
+    gfx_blit_source(ctx, x, y, w, h, &src);
+}
+
+// Expand a 1bpp mask: set bits in `fg`, clear bits in `bg` (GFX_COLOR_NONE
+// leaves them untouched)
+void gfx_blit_mask(GraphicsContext* ctx, int x, int y, const u8* bits, int w, int h, int stride,
+                   u16 fg, u16 bg) {
+    if (!bits) return;
+    GfxBlitSource src = {.mode = GFX_BLIT_MASK, .bits = bits, .stride = stride, .fg = fg, .bg = bg};
+    gfx_blit_source(ctx, x, y, w, h, &src);
+}
+
+// Draw rectangle outline
+void gfx_draw_rect(GraphicsContext* ctx, int x, int y, int w, int h, int thickness, u16 color) {
+    if (thickness <= 0) return;
+
+    // Top and bottom
+    gfx_fill_logical_rect(ctx, x, y, w, thickness, color);
+    gfx_fill_logical_rect(ctx, x, y + h - thickness, w, thickness, color);
+    // Left and right
+    gfx_fill_logical_rect(ctx, x, y, thickness, h, color);
+    gfx_fill_logical_rect(ctx, x + w - thickness, y, thickness, h, color);
+}
+
 // Draw filled rectangle
 void gfx_draw_filled_rect(GraphicsContext* ctx, int x, int y, int w, int h, u16 color) {
-    for (int dy = 0; dy < h; dy++) {
-        for (int dx = 0; dx < w; dx++) {
-            gfx_plot(ctx, x + dx, y + dy, color);
+    gfx_fill_logical_rect(ctx, x, y, w, h, color);
+}
+
+// Bands of equal weight along the axis: the weight of step i is
+// round(i * 32 / (length - 1)), advanced in 16.16 fixed point
+void gfx_fill_gradient(GraphicsContext* ctx, int x, int y, int w, int h, u16 from, u16 to,
+                       GfxGradientAxis axis) {
+    if (!ctx->framebuffer || w <= 0 || h <= 0) return;
+
+    bool horizontal = axis == GFX_GRADIENT_HORIZONTAL;
+    int length = horizontal ? w : h;
+    u32 step = length > 1 ? ((u32)COLOR_WEIGHT_MAX << 16) / (u32)(length - 1) : 0;
+    u32 weight = 1u << 15;
+    int band_start = 0;
+    int band_weight = 0;
+
+    for (int i = 1; i <= length; i++) {
+        weight += step;
+        int next = (int)(weight >> 16);
+        if (i < length && next == band_weight) continue;
+
+        u16 color = color_lerp(from, to, band_weight);
+        if (horizontal) {
+            gfx_fill_logical_rect(ctx, x + band_start, y, i - band_start, h, color);
+        } else {
+            gfx_fill_logical_rect(ctx, x, y + band_start, w, i - band_start, color);
         }
+        band_start = i;
+        band_weight = next;
     }
 }
 
-// Clear entire screen
+// Clear the clip rect, the entire screen unless one is pushed (ignores the
+// current rotation)
 void gfx_clear(GraphicsContext* ctx, u16 color) {
-    RotationAngle saved_rotation = ctx->rotation;
-    int saved_px = ctx->pivot_x;
-    int saved_py = ctx->pivot_y;
+    if (!ctx->framebuffer) return;
+    gfx_fill_physical_rect(ctx, 0, 0, ctx->width, ctx->height, color);
+}
+
+// Put back a logical rect from a pre-rendered surface of the same size
+void gfx_restore_rect(GraphicsContext* ctx, const u16* source, int x, int y, int w, int h) {
+    if (!ctx->framebuffer || !source || w <= 0 || h <= 0) return;
+
+    int ax, ay, bx, by;
+    gfx_transform_point(ctx, x, y, &ax, &ay);
+    gfx_transform_point(ctx, x + w - 1, y + h - 1, &bx, &by);
+
+    const GfxRect* clip = &ctx->clip;
+    int x0 = gfx_max_int(gfx_min_int(ax, bx), clip->x);
+    int y0 = gfx_max_int(gfx_min_int(ay, by), clip->y);
+    int x1 = gfx_min_int(gfx_max_int(ax, bx) + 1, clip->x + clip->width);
+    int y1 = gfx_min_int(gfx_max_int(ay, by) + 1, clip->y + clip->height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    if (ctx->commands) {
+        gfx_record_copy(ctx, source, x0, y0, x1, y1);
+        return;
+    }
+    gfx_copy_clipped_rect(ctx, source, x0, y0, x1, y1);
+}
+
+// Display-list record types
+typedef enum {
+    GFX_CMD_FILL,       // Solid physical rect, already clipped
+    GFX_CMD_STATE,      // Transform and clip for the replayed records after it
+    GFX_CMD_LINE,
+    GFX_CMD_LINE_AA,
+    GFX_CMD_BLIT,
+    GFX_CMD_COPY        // Physical rect from a same-sized surface, already clipped
+} GfxCommandType;
+
+// Record header; `words` covers the header and its payload. The bounds are
+// conservative: nothing outside them is written when the record executes.
+typedef struct {
+    u8 type;
+    u8 words;
+    u16 color;
+    s16 x0, y0, x1, y1;     // Physical [x0, x1) x [y0, y1), within the clip
+} GfxCommand;
+
+typedef struct {
+    RotationAngle rotation;
+    int pivot_x;
+    int pivot_y;
+    GfxRect clip;
+} GfxStateCommand;
+
+typedef struct {
+    int x0, y0, x1, y1;
+} GfxLineCommand;
+
+typedef struct {
+    int x0, y0, x1, y1;
+    int thickness;
+    const GfxBlendRamp* ramp;
+} GfxLineAaCommand;
+
+typedef struct {
+    int x, y, w, h;
+    GfxBlitSource src;
+} GfxBlitCommand;
+
+typedef struct {
+    const u16* source;
+} GfxCopyCommand;
+
+#define GFX_COMMAND_WORDS(payload) ((int)((sizeof(GfxCommand) + sizeof(payload) + 3) / 4))
+
+// Smallest arena accepted by gfx_begin_commands; any record plus a state
+// record always fits once the arena has been executed
+#define GFX_COMMAND_MIN_WORDS 64
+
+// Fills at least this large are considered as occluders when culling
+#define GFX_OCCLUDER_MIN_AREA 64
+#define GFX_MAX_OCCLUDERS 8
+
+static inline GfxCommand* gfx_command_at(const GfxCommandList* list, int offset) {
+    return (GfxCommand*)(list->arena + offset);
+}
+
+// Set up a list over a caller-provided arena (`words` 32-bit words)
+void gfx_command_list_init(GfxCommandList* list, u32* arena, int words) {
+    if (!list) return;
+    list->arena = arena;
+    list->capacity = words;
+    list->used = 0;
+    list->count = 0;
+    list->last = -1;
+    list->state_valid = false;
+    gfx_command_stats_reset(list);
+}
+
+void gfx_command_stats_reset(GfxCommandList* list) {
+    if (!list) return;
+    memset(&list->stats, 0, sizeof(list->stats));
+}
 
-    ctx->rotation = ROTATION_0;
-    ctx->pivot_x = ctx->width / 2;
-    ctx->pivot_y = ctx->height / 2;
+// Start recording into `list` (anything recorded before is executed first)
+void gfx_begin_commands(GraphicsContext* ctx, GfxCommandList* list) {
+    if (!ctx || !list || !list->arena || list->capacity < GFX_COMMAND_MIN_WORDS) return;
+    gfx_execute_commands(ctx);
+    ctx->commands = list;
+}
+
+// Execute what is left and go back to drawing immediately
+void gfx_end_commands(GraphicsContext* ctx) {
+    if (!ctx || !ctx->commands) return;
+    gfx_execute_commands(ctx);
+    ctx->commands = NULL;
+}
+
+// Append a record of `words` words; room must have been reserved
+static GfxCommand* gfx_command_append(GraphicsContext* ctx, GfxCommandType type, int words,
+                                      int x0, int y0, int x1, int y1, u16 color) {
+    GfxCommandList* list = ctx->commands;
+    GfxCommand* cmd = gfx_command_at(list, list->used);
+    cmd->type = (u8)type;
+    cmd->words = (u8)words;
+    cmd->color = color;
+    cmd->x0 = (s16)x0;
+    cmd->y0 = (s16)y0;
+    cmd->x1 = (s16)x1;
+    cmd->y1 = (s16)y1;
+    list->last = list->used;
+    list->used += words;
+    list->count++;
+    list->stats.recorded++;
+    return cmd;
+}
+
+// Make room for `words` more words
+static void gfx_command_reserve(GraphicsContext* ctx, int words) {
+    GfxCommandList* list = ctx->commands;
+    if (list->used + words <= list->capacity) return;
+    list->stats.flushes++;
+    gfx_execute_commands(ctx);
+}
+
+// Record a solid physical rect, growing the previous fill when the two form
+// one rectangle of the same color
+static void gfx_record_fill(GraphicsContext* ctx, int x0, int y0, int x1, int y1, u16 color) {
+    GfxCommandList* list = ctx->commands;
+
+    if (list->last >= 0) {
+        GfxCommand* prev = gfx_command_at(list, list->last);
+        if (prev->type == GFX_CMD_FILL && prev->color == color) {
+            if (prev->x0 == x0 && prev->x1 == x1 && prev->y1 == y0) {
+                prev->y1 = (s16)y1;
+                list->stats.merged++;
+                return;
+            }
+            if (prev->y0 == y0 && prev->y1 == y1 && prev->x1 == x0) {
+                prev->x1 = (s16)x1;
+                list->stats.merged++;
+                return;
+            }
+        }
+    }
+
+    int words = (int)(sizeof(GfxCommand) / 4);
+    gfx_command_reserve(ctx, words);
+    gfx_command_append(ctx, GFX_CMD_FILL, words, x0, y0, x1, y1, color);
+}
+
+// Start a replayed record whose output stays within the physical box
+// [x0, x1] x [y0, y1]. Emits a state record first when the transform or
+// clip changed. Returns the payload, or NULL when nothing would be visible.
+static void* gfx_record_replay(GraphicsContext* ctx, GfxCommandType type, int payload_bytes,
+                               int x0, int y0, int x1, int y1, u16 color) {
+    const GfxRect* clip = &ctx->clip;
+    x0 = gfx_max_int(x0, clip->x);
+    y0 = gfx_max_int(y0, clip->y);
+    x1 = gfx_min_int(x1 + 1, clip->x + clip->width);
+    y1 = gfx_min_int(y1 + 1, clip->y + clip->height);
+    if (x0 >= x1 || y0 >= y1) return NULL;
+
+    int words = (int)((sizeof(GfxCommand) + payload_bytes + 3) / 4);
+    gfx_command_reserve(ctx, words + GFX_COMMAND_WORDS(GfxStateCommand));
+
+    GfxCommandList* list = ctx->commands;
+    bool same_state = list->state_valid && list->rotation == ctx->rotation &&
+                      list->pivot_x == ctx->pivot_x && list->pivot_y == ctx->pivot_y &&
+                      memcmp(&list->clip, clip, sizeof(GfxRect)) == 0;
+    if (!same_state) {
+        GfxCommand* cmd = gfx_command_append(ctx, GFX_CMD_STATE, GFX_COMMAND_WORDS(GfxStateCommand),
+                                             0, 0, 0, 0, 0);
+        GfxStateCommand* state = (GfxStateCommand*)(cmd + 1);
+        state->rotation = ctx->rotation;
+        state->pivot_x = ctx->pivot_x;
+        state->pivot_y = ctx->pivot_y;
+        state->clip = *clip;
+
+        list->state_valid = true;
+        list->rotation = ctx->rotation;
+        list->pivot_x = ctx->pivot_x;
+        list->pivot_y = ctx->pivot_y;
+        list->clip = *clip;
+    }
+
+    return gfx_command_append(ctx, type, words, x0, y0, x1, y1, color) + 1;
+}
+
+static void gfx_record_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1, u16 color) {
+    int ax, ay, bx, by;
+    gfx_transform_point(ctx, x0, y0, &ax, &ay);
+    gfx_transform_point(ctx, x1, y1, &bx, &by);
+
+    GfxLineCommand* line = gfx_record_replay(ctx, GFX_CMD_LINE, sizeof(GfxLineCommand),
+                                             gfx_min_int(ax, bx), gfx_min_int(ay, by),
+                                             gfx_max_int(ax, bx), gfx_max_int(ay, by), color);
+    if (!line) return;
+    line->x0 = x0;
+    line->y0 = y0;
+    line->x1 = x1;
+    line->y1 = y1;
+}
+
+static void gfx_record_line_aa(GraphicsContext* ctx, int x0, int y0, int x1, int y1, int thickness,
+                               const GfxBlendRamp* ramp) {
+    int ax, ay, bx, by;
+    gfx_transform_point(ctx, x0, y0, &ax, &ay);
+    gfx_transform_point(ctx, x1, y1, &bx, &by);
+
+    // The band spreads up to this far across the line, on either axis
+    int pad = thickness / 2 + 1;
+    GfxLineAaCommand* line = gfx_record_replay(ctx, GFX_CMD_LINE_AA, sizeof(GfxLineAaCommand),
+                                               gfx_min_int(ax, bx) - pad, gfx_min_int(ay, by) - pad,
+                                               gfx_max_int(ax, bx) + pad, gfx_max_int(ay, by) + pad, 0);
+    if (!line) return;
+    line->x0 = x0;
+    line->y0 = y0;
+    line->x1 = x1;
+    line->y1 = y1;
+    line->thickness = thickness;
+    line->ramp = ramp;
+}
+
+static void gfx_record_blit(GraphicsContext* ctx, int x, int y, int w, int h, const GfxBlitSource* src) {
+    int ax, ay, bx, by;
+    gfx_transform_point(ctx, x, y, &ax, &ay);
+    gfx_transform_point(ctx, x + w - 1, y + h - 1, &bx, &by);
+
+    GfxBlitCommand* blit = gfx_record_replay(ctx, GFX_CMD_BLIT, sizeof(GfxBlitCommand),
+                                             gfx_min_int(ax, bx), gfx_min_int(ay, by),
+                                             gfx_max_int(ax, bx), gfx_max_int(ay, by), 0);
+    if (!blit) return;
+    blit->x = x;
+    blit->y = y;
+    blit->w = w;
+    blit->h = h;
+    blit->src = *src;
+}
+
+// Record a restored physical rect. Like a fill it needs no state record.
+static void gfx_record_copy(GraphicsContext* ctx, const u16* source, int x0, int y0, int x1, int y1) {
+    int words = GFX_COMMAND_WORDS(GfxCopyCommand);
+    gfx_command_reserve(ctx, words);
+    GfxCommand* cmd = gfx_command_append(ctx, GFX_CMD_COPY, words, x0, y0, x1, y1, 0);
+    ((GfxCopyCommand*)(cmd + 1))->source = source;
+}
+
+// Large fill or copy that hides everything recorded before it within its bounds
+typedef struct {
+    int x0, y0, x1, y1;
+    int index;
+    int area;
+} GfxOccluder;
+
+// Keep the largest opaque rects; culling only needs a few good occluders
+static int gfx_collect_occluders(const GfxCommandList* list, GfxOccluder* out) {
+    int count = 0;
+    int index = 0;
+    for (int offset = 0; offset < list->used; index++) {
+        const GfxCommand* cmd = gfx_command_at(list, offset);
+        offset += cmd->words;
+        if (cmd->type != GFX_CMD_FILL && cmd->type != GFX_CMD_COPY) continue;
+
+        int area = (cmd->x1 - cmd->x0) * (cmd->y1 - cmd->y0);
+        if (area < GFX_OCCLUDER_MIN_AREA) continue;
+
+        int slot = count;
+        if (count == GFX_MAX_OCCLUDERS) {
+            slot = 0;
+            for (int i = 1; i < count; i++) {
+                if (out[i].area < out[slot].area) slot = i;
+            }
+            if (out[slot].area >= area) continue;
+        } else {
+            count++;
+        }
+        out[slot] = (GfxOccluder){cmd->x0, cmd->y0, cmd->x1, cmd->y1, index, area};
+    }
+    return count;
+}
+
+static bool gfx_command_occluded(const GfxCommand* cmd, int index, const GfxOccluder* occluders, int count) {
+    for (int i = 0; i < count; i++) {
+        const GfxOccluder* o = &occluders[i];
+        if (o->index > index && o->x0 <= cmd->x0 && o->y0 <= cmd->y0 &&
+            o->x1 >= cmd->x1 && o->y1 >= cmd->y1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Draw everything recorded so far, then empty the arena
+void gfx_execute_commands(GraphicsContext* ctx) {
+    if (!ctx || !ctx->commands) return;
+    GfxCommandList* list = ctx->commands;
+    if (list->count == 0) return;
+
+    GfxOccluder occluders[GFX_MAX_OCCLUDERS];
+    int occluder_count = gfx_collect_occluders(list, occluders);
+
+    // Replayed records go through the normal primitives under their state;
+    // fills and copies were clipped when recorded and only need the surface
+    RotationAngle rotation = ctx->rotation;
+    int pivot_x = ctx->pivot_x;
+    int pivot_y = ctx->pivot_y;
+    GfxRect clip = ctx->clip;
+    GfxRect surface = {0, 0, ctx->width, ctx->height};
+    GfxRect replay_clip = surface;
+    ctx->commands = NULL;
+
+    int index = 0;
+    for (int offset = 0; offset < list->used; index++) {
+        const GfxCommand* cmd = gfx_command_at(list, offset);
+        offset += cmd->words;
+
+        if (cmd->type != GFX_CMD_STATE && gfx_command_occluded(cmd, index, occluders, occluder_count)) {
+            list->stats.culled++;
+            continue;
+        }
+        list->stats.executed++;
+
+        switch (cmd->type) {
+            case GFX_CMD_FILL:
+                ctx->clip = surface;
+                gfx_fill_clipped_rect(ctx, cmd->x0, cmd->y0, cmd->x1, cmd->y1, cmd->color);
+                list->stats.pixels += (cmd->x1 - cmd->x0) * (cmd->y1 - cmd->y0);
+                break;
+
+            case GFX_CMD_STATE: {
+                const GfxStateCommand* state = (const GfxStateCommand*)(cmd + 1);
+                gfx_set_transform(ctx, state->rotation, state->pivot_x, state->pivot_y);
+                replay_clip = state->clip;
+                break;
+            }
+
+            case GFX_CMD_LINE: {
+                const GfxLineCommand* line = (const GfxLineCommand*)(cmd + 1);
+                ctx->clip = replay_clip;
+                gfx_draw_line(ctx, line->x0, line->y0, line->x1, line->y1, cmd->color);
+                break;
+            }
+
+            case GFX_CMD_LINE_AA: {
+                const GfxLineAaCommand* line = (const GfxLineAaCommand*)(cmd + 1);
+                ctx->clip = replay_clip;
+                gfx_draw_thick_line_aa(ctx, line->x0, line->y0, line->x1, line->y1,
+                                       line->thickness, line->ramp);
+                break;
+            }
+
+            case GFX_CMD_BLIT: {
+                const GfxBlitCommand* blit = (const GfxBlitCommand*)(cmd + 1);
+                ctx->clip = replay_clip;
+                gfx_blit_source(ctx, blit->x, blit->y, blit->w, blit->h, &blit->src);
+                break;
+            }
+
+            case GFX_CMD_COPY: {
+                const GfxCopyCommand* copy = (const GfxCopyCommand*)(cmd + 1);
+                ctx->clip = surface;
+                gfx_copy_clipped_rect(ctx, copy->source, cmd->x0, cmd->y0, cmd->x1, cmd->y1);
+                break;
+            }
+        }
+    }
 
-    gfx_draw_filled_rect(ctx, 0, 0, ctx->width, ctx->height, color);
+    gfx_set_transform(ctx, rotation, pivot_x, pivot_y);
+    ctx->clip = clip;
+    ctx->commands = list;
 
-    ctx->rotation = saved_rotation;
-    ctx->pivot_x = saved_px;
-    ctx->pivot_y = saved_py;
+    list->used = 0;
+    list->count = 0;
+    list->last = -1;
+    list->state_valid = false;
 }
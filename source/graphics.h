@@ -12,19 +12,116 @@ typedef enum {
     ROTATION_270    // 270° clockwise (90° counter-clockwise)
 } RotationAngle;
 
+// Maximum number of separate damage rects tracked per context per frame
+#define GFX_MAX_DAMAGE_RECTS 16
+
+// Rectangle in physical screen coordinates
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} GfxRect;
+
+// Color with the alpha bit clear; as a mask background it means "leave the
+// pixel as is"
+#define GFX_COLOR_NONE 0
+
+// Anti-aliasing coverage levels per blend ramp
+#define GFX_AA_SHIFT 4
+#define GFX_AA_LEVELS (1 << GFX_AA_SHIFT)
+
+// Foreground blended over a background at each coverage level: shades[0] is
+// the background, shades[GFX_AA_LEVELS - 1] the foreground. Build once per
+// theme so anti-aliased drawing never reads VRAM or divides per pixel.
+typedef struct {
+    u16 shades[GFX_AA_LEVELS];
+} GfxBlendRamp;
+
+// Point in logical coordinates
+typedef struct {
+    int x;
+    int y;
+} GfxPoint;
+
+// Largest vertex count accepted by gfx_fill_polygon
+#define GFX_MAX_POLYGON_POINTS 16
+
+// Nesting depth of gfx_push_clip
+#define GFX_MAX_CLIP_DEPTH 4
+
+// Display-list counters, accumulated until gfx_command_stats_reset
+typedef struct {
+    int recorded;   // Commands appended to the arena
+    int merged;     // Fills folded into the previous command instead
+    int culled;     // Commands skipped because a later fill covers them
+    int executed;   // Commands drawn
+    int pixels;     // Pixels written by executed fills
+    int flushes;    // Early executions forced by a full arena
+} GfxCommandStats;
+
+// Per-frame command arena. Records are variable-sized and word-aligned.
+typedef struct {
+    u32* arena;
+    int capacity;       // Arena size in words
+    int used;           // Words recorded since the last execution
+    int count;          // Records since the last execution
+    int last;           // Word offset of the newest record, or -1
+    // Transform and clip of the newest state record; lines, AA lines and
+    // blits are replayed through the normal primitives under it
+    bool state_valid;
+    RotationAngle rotation;
+    int pivot_x;
+    int pivot_y;
+    GfxRect clip;
+    GfxCommandStats stats;
+} GfxCommandList;
+
 // Graphics context for rotation-aware drawing
 typedef struct {
     u16* framebuffer;
     RotationAngle rotation;  // Current rotation angle
-    int width;         // Logical width (before rotation)
-    int height;        // Logical height (before rotation)
+    int width;         // Surface width in pixels (also the framebuffer pitch)
+    int height;        // Surface height in pixels
     int pivot_x;       // Rotation pivot X
     int pivot_y;       // Rotation pivot Y
+    // Transform derived from rotation + pivot. Only change rotation or pivot
+    // through gfx_init / gfx_set_* so these stay in sync.
+    int origin_x;      // Physical X of logical (0, 0)
+    int origin_y;      // Physical Y of logical (0, 0)
+    int stride_x;      // Framebuffer offset of one logical X step
+    int stride_y;      // Framebuffer offset of one logical Y step
+    // Physical rectangle drawing is limited to; always within the surface
+    GfxRect clip;
+    GfxRect clip_stack[GFX_MAX_CLIP_DEPTH];
+    int clip_depth;
+    // Display list being recorded into, or NULL to draw immediately
+    GfxCommandList* commands;
+    // Regions touched by gfx_* primitives since the last gfx_damage_clear
+    GfxRect damage[GFX_MAX_DAMAGE_RECTS];
+    int damage_count;
+    // Double buffering: `framebuffer` is the back buffer, `front_buffer` the
+    // one being scanned out (NULL when drawing straight to the display).
+    u16* front_buffer;
+    // Shadow surface: `framebuffer` is a cached main-RAM copy and
+    // `shadow_target` the VRAM it is uploaded to (NULL when not shadowed).
+    u16* shadow_target;
+    // Framebuffer is cached main RAM (an off-screen surface): never DMA into it
+    bool offscreen;
+    bool present_pending;
+    // Damage of the frame queued for presentation; copied into the new back
+    // buffer after a flip, or uploaded from the shadow surface
+    GfxRect present_damage[GFX_MAX_DAMAGE_RECTS];
+    int present_count;
 } GraphicsContext;
 
 // Initialize graphics context
 void gfx_init(GraphicsContext* ctx, u16* fb, int width, int height, RotationAngle rotation);
 
+// Initialize a context over a cached main-RAM surface, e.g. a pre-rendered
+// background for gfx_restore_rect. Fills use CPU stores instead of DMA.
+void gfx_init_offscreen(GraphicsContext* ctx, u16* buffer, int width, int height);
+
 // Set rotation angle
 void gfx_set_rotation(GraphicsContext* ctx, RotationAngle rotation);
 
@@ -34,14 +131,107 @@ void gfx_set_pivot(GraphicsContext* ctx, int pivot_x, int pivot_y);
 // Convenience: set rotation and pivot together
 void gfx_set_transform(GraphicsContext* ctx, RotationAngle rotation, int pivot_x, int pivot_y);
 
+// Clipping. gfx_push_clip narrows the clip to its intersection with a
+// physical rectangle; gfx_pop_clip restores the previous one. Primitives are
+// clipped before rasterization, and damage never extends past the clip.
+bool gfx_push_clip(GraphicsContext* ctx, int x, int y, int w, int h);
+void gfx_pop_clip(GraphicsContext* ctx);
+
+// Display lists. Between gfx_begin_commands and gfx_end_commands the gfx_*
+// primitives append compact records to the list's arena instead of drawing;
+// gfx_execute_commands then draws them in one pass. Adjacent fills of one
+// color are merged while recording, and anything wholly covered by a later
+// solid fill or restored rect is skipped. Damage is recorded as commands
+// execute. Blit sources, blend ramps and gfx_restore_rect surfaces are
+// referenced, not copied, so they must stay valid until execution. A full arena is executed early.
+void gfx_command_list_init(GfxCommandList* list, u32* arena, int words);
+void gfx_command_stats_reset(GfxCommandList* list);
+void gfx_begin_commands(GraphicsContext* ctx, GfxCommandList* list);
+void gfx_end_commands(GraphicsContext* ctx);
+void gfx_execute_commands(GraphicsContext* ctx);
+
 // Basic pixel plotting
 void gfx_plot(GraphicsContext* ctx, int x, int y, u16 color);
 
 // Drawing primitives
 void gfx_draw_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1, u16 color);
 void gfx_draw_thick_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1, int thickness, u16 color);
+void gfx_draw_tapered_line(GraphicsContext* ctx, int x0, int y0, int x1, int y1,
+                           int start_width, int end_width, u16 color);
+
+// Circles by the midpoint rule (pixels within radius + 1/2 of the center),
+// filled as horizontal spans. Arc angles are whole degrees clockwise from
+// 12 o'clock in logical space; the arc sweeps clockwise from `start`.
+void gfx_fill_disc(GraphicsContext* ctx, int cx, int cy, int radius, u16 color);
+void gfx_draw_circle(GraphicsContext* ctx, int cx, int cy, int radius, u16 color);
+void gfx_draw_ring(GraphicsContext* ctx, int cx, int cy, int radius, int thickness, u16 color);
+void gfx_draw_arc(GraphicsContext* ctx, int cx, int cy, int radius, int thickness,
+                  int start, int sweep, u16 color);
+
+// Bitmap blits to logical (x, y) under the current rotation. `stride` is the
+// source row pitch in pixels (RGB15) or bytes (1bpp, MSB = leftmost pixel).
+void gfx_blit(GraphicsContext* ctx, int x, int y, const u16* pixels, int w, int h, int stride);
+void gfx_blit_colorkey(GraphicsContext* ctx, int x, int y, const u16* pixels, int w, int h, int stride,
+                       u16 key);
+void gfx_blit_mask(GraphicsContext* ctx, int x, int y, const u8* bits, int w, int h, int stride,
+                   u16 fg, u16 bg);
+
+// Convex polygons, filled one span per row so no pixel is written twice.
+// Integer vertices are pixel centers; non-convex input fills its row-wise hull.
+void gfx_fill_polygon(GraphicsContext* ctx, const GfxPoint* points, int count, u16 color);
+void gfx_fill_quad(GraphicsContext* ctx, int x0, int y0, int x1, int y1,
+                   int x2, int y2, int x3, int y3, u16 color);
 void gfx_draw_rect(GraphicsContext* ctx, int x, int y, int w, int h, int thickness, u16 color);
 void gfx_draw_filled_rect(GraphicsContext* ctx, int x, int y, int w, int h, u16 color);
 void gfx_clear(GraphicsContext* ctx, u16 color);
 
+// Copy a logical rect from `source`, a surface with the context's size and
+// pitch (such as one drawn through gfx_init_offscreen), to the same place in
+// the framebuffer. Rows are DMAed when the framebuffer is VRAM, so flush the
+// source out of the data cache (DC_FlushRange) after drawing into it.
+void gfx_restore_rect(GraphicsContext* ctx, const u16* source, int x, int y, int w, int h);
+
+// Axis of gfx_fill_gradient, in logical coordinates
+typedef enum {
+    GFX_GRADIENT_HORIZONTAL,    // `from` at the left edge, `to` at the right
+    GFX_GRADIENT_VERTICAL       // `from` at the top edge, `to` at the bottom
+} GfxGradientAxis;
+
+// Linear gradient (color.h weights, 33 steps at most). Each run of equal
+// color is one solid rect through the span fill path.
+void gfx_fill_gradient(GraphicsContext* ctx, int x, int y, int w, int h, u16 from, u16 to,
+                       GfxGradientAxis axis);
+
+// Anti-aliased primitives (integer Wu), blended through a precomputed ramp
+void gfx_build_blend_ramp(GfxBlendRamp* ramp, u16 background, u16 foreground);
+void gfx_draw_line_aa(GraphicsContext* ctx, int x0, int y0, int x1, int y1, const GfxBlendRamp* ramp);
+void gfx_draw_thick_line_aa(GraphicsContext* ctx, int x0, int y0, int x1, int y1, int thickness,
+                            const GfxBlendRamp* ramp);
+
+// Damage tracking. Every primitive records the physical area it wrote; the
+// main loop flushes a screen only when its list is non-empty, then clears it.
+void gfx_damage_add(GraphicsContext* ctx, int x, int y, int w, int h);
+int gfx_damage_count(const GraphicsContext* ctx);
+const GfxRect* gfx_damage_get(const GraphicsContext* ctx, int index);
+bool gfx_damage_bounds(const GraphicsContext* ctx, GfxRect* out);
+bool gfx_damage_intersects(const GraphicsContext* ctx, int x, int y, int w, int h);
+void gfx_damage_clear(GraphicsContext* ctx);
+
+// Presentation. Draw into ctx->framebuffer, call gfx_queue_present once the
+// frame is complete, then during VBlank:
+//  - double buffering: gfx_flip swaps the pointers; the caller switches the
+//    display (e.g. MODE_FB0/MODE_FB1) and then calls gfx_sync_back_buffer to
+//    copy the presented damage forward.
+//  - shadow surface: gfx_upload_shadow flushes the presented damage out of
+//    the data cache and DMAs it to VRAM.
+// The two modes are exclusive; enabling one disables the other.
+void gfx_enable_double_buffer(GraphicsContext* ctx, u16* front, u16* back);
+void gfx_disable_double_buffer(GraphicsContext* ctx);
+void gfx_enable_shadow(GraphicsContext* ctx, u16* shadow);
+void gfx_disable_shadow(GraphicsContext* ctx);
+bool gfx_queue_present(GraphicsContext* ctx);
+bool gfx_flip(GraphicsContext* ctx);
+void gfx_sync_back_buffer(GraphicsContext* ctx);
+bool gfx_upload_shadow(GraphicsContext* ctx);
+
 #endif // GRAPHICS_H
@@ -0,0 +1,77 @@
+#include "idle.h"
+
+#define IDLE_BACKLIGHTS (PM_BACKLIGHT_TOP | PM_BACKLIGHT_BOTTOM)
+
+static void idle_set_brightness(IdleMonitor* idle, int level) {
+    idle->brightness = level;
+    setBrightness(3, level);
+}
+
+void idle_init(IdleMonitor* idle, u32 timeout_frames, u32 vblank_count) {
+    if (!idle) return;
+
+    idle->level = IDLE_ACTIVE;
+    idle->timeout_frames = timeout_frames;
+    idle->last_input = vblank_count;
+    idle->fade = 0;
+    idle->backlight_off = false;
+    idle_set_brightness(idle, 0);
+}
+
+IdleChange idle_vblank(IdleMonitor* idle, u32 vblank_count, bool input) {
+    if (!idle) return IDLE_CHANGE_NONE;
+
+    if (idle->fade != 0) {
+        int level = idle->brightness + idle->fade;
+        if (level <= IDLE_BRIGHTNESS_OFF) {
+            level = IDLE_BRIGHTNESS_OFF;
+            idle->fade = 0;
+            // Faded to black: the backlights have nothing left to show
+            powerOff(IDLE_BACKLIGHTS);
+            idle->backlight_off = true;
+        } else if (level >= 0) {
+            level = 0;
+            idle->fade = 0;
+        }
+        idle_set_brightness(idle, level);
+    }
+
+    if (input) {
+        idle->last_input = vblank_count;
+        return idle->level == IDLE_DEEP ? IDLE_CHANGE_LEAVE : IDLE_CHANGE_NONE;
+    }
+
+    if (idle->level == IDLE_ACTIVE && idle->timeout_frames > 0 &&
+        vblank_count - idle->last_input >= idle->timeout_frames) {
+        return IDLE_CHANGE_ENTER;
+    }
+    return IDLE_CHANGE_NONE;
+}
+
+void idle_enter(IdleMonitor* idle) {
+    if (!idle || idle->level == IDLE_DEEP) return;
+
+    idle->level = IDLE_DEEP;
+    idle->fade = -IDLE_FADE_STEP;
+}
+
+void idle_leave(IdleMonitor* idle, u32 vblank_count) {
+    if (!idle || idle->level == IDLE_ACTIVE) return;
+
+    idle->level = IDLE_ACTIVE;
+    idle->last_input = vblank_count;
+    if (idle->backlight_off) {
+        powerOn(IDLE_BACKLIGHTS);
+        idle->backlight_off = false;
+    }
+    idle->fade = IDLE_FADE_STEP;
+}
+
+void idle_sleep(IdleMonitor* idle) {
+    if (!idle) return;
+
+    // Go dark at once; there is no one to watch a fade
+    idle_set_brightness(idle, IDLE_BRIGHTNESS_OFF);
+    idle->fade = 0;
+    systemSleep();
+}
@@ -0,0 +1,51 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <nds.h>
+#include <stdbool.h>
+
+// Master brightness of a faded-out screen (libnds setBrightness range)
+#define IDLE_BRIGHTNESS_OFF (-16)
+
+// Brightness steps per frame: a full fade takes 16 frames
+#define IDLE_FADE_STEP 1
+
+typedef enum {
+    IDLE_ACTIVE,    // Normal operation
+    IDLE_DEEP       // No input for a while, or the lid is closed
+} IdleLevel;
+
+// What idle_vblank asks the app to do this frame
+typedef enum {
+    IDLE_CHANGE_NONE,
+    IDLE_CHANGE_ENTER,  // The inactivity timeout ran out: call idle_enter
+    IDLE_CHANGE_LEAVE   // Input while idle: call idle_leave
+} IdleChange;
+
+// Tracks input and drives the screens' power. Entering idle fades both
+// screens out with the master brightness and then powers the backlights
+// off; leaving turns them back on and fades in. Neither touches the
+// framebuffers, so nothing is redrawn.
+typedef struct {
+    IdleLevel level;
+    u32 timeout_frames;     // Frames without input before going idle (0 = never)
+    u32 last_input;         // VBlank count of the last input
+    int brightness;         // Both screens, IDLE_BRIGHTNESS_OFF (black) to 0
+    int fade;               // Brightness change per frame; 0 when settled
+    bool backlight_off;
+} IdleMonitor;
+
+void idle_init(IdleMonitor* idle, u32 timeout_frames, u32 vblank_count);
+
+// Call once per VBlank with whether any key or the pen was held. Steps the
+// fade and reports when the app should enter or leave idle.
+IdleChange idle_vblank(IdleMonitor* idle, u32 vblank_count, bool input);
+
+void idle_enter(IdleMonitor* idle);
+void idle_leave(IdleMonitor* idle, u32 vblank_count);
+
+// Lid closed: sleep in systemSleep until it opens. Call idle_enter first
+// and idle_leave afterwards.
+void idle_sleep(IdleMonitor* idle);
+
+#endif // IDLE_H
@@ -0,0 +1,258 @@
+#include "kernel_bench.h"
+#include "geom.h"
+#include "kernels.h"
+
+#include <stdio.h>
+
+// Timed calls per kernel; the minimum is reported to skip cache warm-up
+#define KERNEL_BENCH_RUNS 4
+#define KERNEL_BENCH_KEY 0x801Fu
+
+// Operations per timed geometry loop
+#define GEOM_BENCH_OPS 256
+
+typedef void (*KernelBenchFn)(uint16_t* dst, const uint16_t* src, int count);
+
+typedef struct {
+    const char* name;
+    KernelBenchFn c;
+    KernelBenchFn arm;  // NULL off the DS
+    int dst_offset;     // Pixels; an odd offset against src breaks word pairing
+} KernelBenchCase;
+
+// Source pixels in main RAM, as for blits from widget bitmaps
+static uint16_t bench_source[KERNEL_BENCH_PIXELS];
+
+// Adapt each kernel to the (dst, src, count) shape of the table below
+#define KERNEL_BENCH_WRAPPERS(suffix)                                                   \
+    static void bench_fill16##suffix(uint16_t* dst, const uint16_t* src, int count) {  \
+        (void)src;                                                                      \
+        kernel_fill16##suffix(dst, 0xFC1Fu, count);                                    \
+    }                                                                                   \
+    static void bench_colorkey##suffix(uint16_t* dst, const uint16_t* src, int count) { \
+        kernel_copy16_colorkey##suffix(dst, src, count, KERNEL_BENCH_KEY);              \
+    }                                                                                   \
+    static void bench_blend_n32##suffix(uint16_t* dst, const uint16_t* src, int count) { \
+        kernel_blend_n32##suffix(dst, src, count, 12);                                  \
+    }
+
+KERNEL_BENCH_WRAPPERS(_c)
+#ifdef ARM9
+KERNEL_BENCH_WRAPPERS(_arm)
+#define BENCH_ARM(fn) fn
+#else
+#define BENCH_ARM(fn) NULL
+#endif
+
+static const KernelBenchCase bench_cases[] = {
+    {"fill16", bench_fill16_c, BENCH_ARM(bench_fill16_arm), 0},
+    {"copy16", kernel_copy16_c, BENCH_ARM(kernel_copy16_arm), 0},
+    {"copy16 unaligned", kernel_copy16_c, BENCH_ARM(kernel_copy16_arm), 1},
+    {"colorkey", bench_colorkey_c, BENCH_ARM(bench_colorkey_arm), 0},
+    {"blend50", kernel_blend50_c, BENCH_ARM(kernel_blend50_arm), 0},
+    {"blend_n32", bench_blend_n32_c, BENCH_ARM(bench_blend_n32_arm), 0},
+};
+
+// Operands for the geometry loops: numerators up to 2^20 (signed for the
+// divisions), divisors 1..1024 and line deltas up to 255
+static int32_t bench_num[GEOM_BENCH_OPS];
+static int32_t bench_den[GEOM_BENCH_OPS];
+static volatile int32_t bench_sink;
+
+typedef int32_t (*GeomBenchFn)(void);
+
+typedef struct {
+    const char* name;
+    GeomBenchFn before;     // The `/` code a caller used before
+    GeomBenchFn after;      // Its geom.h replacement
+} GeomBenchCase;
+
+static int32_t bench_div_before(void) {
+    int32_t sum = 0;
+    for (int i = 0; i < GEOM_BENCH_OPS; i++) sum += bench_num[i] / bench_den[i];
+    return sum;
+}
+
+static int32_t bench_div_after(void) {
+    int32_t sum = 0;
+    for (int i = 0; i < GEOM_BENCH_OPS; i++) sum += geom_div(bench_num[i], bench_den[i]);
+    return sum;
+}
+
+// Floor and ceiling of one quotient, as the polygon rasterizer needs per
+// edge and row
+static int32_t bench_floor_ceil_before(void) {
+    int32_t sum = 0;
+    for (int i = 0; i < GEOM_BENCH_OPS; i++) {
+        int32_t n = bench_num[i], d = bench_den[i];
+        int32_t floor_q = n / d - ((n % d != 0 && n < 0) ? 1 : 0);
+        int32_t ceil_q = -((-n) / d - ((-n % d != 0 && -n < 0) ? 1 : 0));
+        sum += floor_q + ceil_q;
+    }
+    return sum;
+}
+
+static int32_t bench_floor_ceil_after(void) {
+    int32_t sum = 0;
+    for (int i = 0; i < GEOM_BENCH_OPS; i++) {
+        int32_t rem;
+        int32_t q = geom_divmod(bench_num[i], bench_den[i], &rem);
+        sum += (rem < 0 ? q - 1 : q) + (rem > 0 ? q + 1 : q);
+    }
+    return sum;
+}
+
+// Visualizer bar averages: many divisions by the same count
+static int32_t bench_same_div_before(void) {
+    int32_t sum = 0;
+    int32_t den = bench_den[0];
+    for (int i = 0; i < GEOM_BENCH_OPS; i++) sum += (bench_num[i] & 0xFFFFF) / den;
+    return sum;
+}
+
+static int32_t bench_same_div_after(void) {
+    int32_t sum = 0;
+    uint32_t recip = geom_reciprocal((uint32_t)bench_den[0]);
+    for (int i = 0; i < GEOM_BENCH_OPS; i++) sum += (int32_t)geom_div_recip(bench_num[i] & 0xFFFFF, recip);
+    return sum;
+}
+
+// Brush stamps of a drawn stroke: one point per step
+static int32_t bench_stroke_before(void) {
+    int32_t sum = 0;
+    int dx = bench_den[1] & 0xFF, dy = bench_den[2] & 0x7F;
+    int steps = dx > dy ? dx : dy;
+    if (steps == 0) return 0;
+    for (int i = 0; i < GEOM_BENCH_OPS; i++) {
+        int k = i % (steps + 1);
+        sum += dx * k / steps + dy * k / steps;
+    }
+    return sum;
+}
+
+static int32_t bench_stroke_after(void) {
+    int32_t sum = 0;
+    GeomDda dda;
+    int steps = geom_dda_init(&dda, 0, 0, bench_den[1] & 0xFF, bench_den[2] & 0x7F);
+    for (int i = 0, k = 0; i < GEOM_BENCH_OPS; i++, k++) {
+        if (k > steps) {
+            geom_dda_init(&dda, 0, 0, bench_den[1] & 0xFF, bench_den[2] & 0x7F);
+            k = 0;
+        }
+        sum += dda.x + dda.y;
+        geom_dda_next(&dda);
+    }
+    return sum;
+}
+
+static const GeomBenchCase geom_bench_cases[] = {
+    {"div", bench_div_before, bench_div_after},
+    {"floor+ceil", bench_floor_ceil_before, bench_floor_ceil_after},
+    {"same divisor", bench_same_div_before, bench_same_div_after},
+    {"stroke step", bench_stroke_before, bench_stroke_after},
+};
+
+// Deterministic pixels with every fourth one set to the colorkey
+static void bench_fill_pattern(uint16_t* buffer, int count, uint32_t seed) {
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        buffer[i] = (i & 3) == 3 ? KERNEL_BENCH_KEY : (uint16_t)(seed >> 16);
+    }
+}
+
+static uint32_t bench_checksum(const uint16_t* buffer, int count) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < count; i++) {
+        hash = (hash ^ buffer[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Best time of KERNEL_BENCH_RUNS calls, in cycles; *checksum gets the
+// output of the first call on a fresh destination
+static uint32_t bench_time(KernelBenchFn fn, uint16_t* dst, KernelBenchClock clock, uint32_t* checksum) {
+    uint32_t best = UINT32_MAX;
+    for (int run = 0; run < KERNEL_BENCH_RUNS; run++) {
+        bench_fill_pattern(dst, KERNEL_BENCH_PIXELS, 7);
+        uint32_t start = clock();
+        fn(dst, bench_source, KERNEL_BENCH_PIXELS);
+        uint32_t elapsed = clock() - start;
+        if (run == 0) *checksum = bench_checksum(dst, KERNEL_BENCH_PIXELS);
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+// Cycles per item in hundredths, printed as "N.NN"
+static void bench_format(char* out, size_t size, uint32_t cycles, uint32_t items) {
+    uint32_t hundredths = (uint32_t)(((uint64_t)cycles * 100 + items / 2) / items);
+    snprintf(out, size, "%lu.%02lu", (unsigned long)(hundredths / 100), (unsigned long)(hundredths % 100));
+}
+
+// Best of KERNEL_BENCH_RUNS loops of GEOM_BENCH_OPS operations, in cycles
+static uint32_t bench_time_geom(GeomBenchFn fn, KernelBenchClock clock, int32_t* result) {
+    uint32_t best = UINT32_MAX;
+    for (int run = 0; run < KERNEL_BENCH_RUNS; run++) {
+        uint32_t start = clock();
+        *result = fn();
+        uint32_t elapsed = clock() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    bench_sink = *result;
+    return best;
+}
+
+static void bench_run_geom(KernelBenchClock clock, KernelBenchLog log) {
+    uint32_t seed = 3;
+    for (int i = 0; i < GEOM_BENCH_OPS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        bench_num[i] = (int32_t)(seed >> 11) - (1 << 20);
+        bench_den[i] = (int32_t)((seed >> 3) & 1023) + 1;
+    }
+
+    for (unsigned i = 0; i < sizeof(geom_bench_cases) / sizeof(geom_bench_cases[0]); i++) {
+        const GeomBenchCase* bench = &geom_bench_cases[i];
+        char before_text[16];
+        char after_text[16];
+        char line[96];
+        int32_t before_result, after_result;
+
+        bench_format(before_text, sizeof(before_text), bench_time_geom(bench->before, clock, &before_result),
+                     GEOM_BENCH_OPS);
+        bench_format(after_text, sizeof(after_text), bench_time_geom(bench->after, clock, &after_result),
+                     GEOM_BENCH_OPS);
+        snprintf(line, sizeof(line), "[geom] %s: before %s after %s cycles/op%s", bench->name, before_text,
+                 after_text, before_result == after_result ? "" : " MISMATCH");
+        log(line);
+    }
+}
+
+void kernel_bench_run(uint16_t* dst, KernelBenchClock clock, KernelBenchLog log) {
+    if (!dst || !clock || !log) return;
+
+    bench_fill_pattern(bench_source, KERNEL_BENCH_PIXELS, 1);
+
+    for (unsigned i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        const KernelBenchCase* bench = &bench_cases[i];
+        uint16_t* target = dst + bench->dst_offset;
+        char c_text[16];
+        char line[96];
+
+        uint32_t c_sum = 0;
+        bench_format(c_text, sizeof(c_text), bench_time(bench->c, target, clock, &c_sum), KERNEL_BENCH_PIXELS);
+
+        if (bench->arm) {
+            char arm_text[16];
+            uint32_t arm_sum = 0;
+            bench_format(arm_text, sizeof(arm_text), bench_time(bench->arm, target, clock, &arm_sum),
+                         KERNEL_BENCH_PIXELS);
+            snprintf(line, sizeof(line), "[kern] %s: c %s asm %s cycles/px%s", bench->name, c_text,
+                     arm_text, arm_sum == c_sum ? "" : " MISMATCH");
+        } else {
+            snprintf(line, sizeof(line), "[kern] %s: c %s cycles/px", bench->name, c_text);
+        }
+        log(line);
+    }
+
+    bench_run_geom(clock, log);
+}
@@ -0,0 +1,23 @@
+#ifndef KERNEL_BENCH_H
+#define KERNEL_BENCH_H
+
+#include <stdint.h>
+
+// Pixels each kernel processes per timed call
+#define KERNEL_BENCH_PIXELS 4096
+
+// Free-running cycle counter; only differences between readings are used
+typedef uint32_t (*KernelBenchClock)(void);
+typedef void (*KernelBenchLog)(const char* line);
+
+// Time every kernel in kernels.h and log one line per kernel with its
+// cycles per pixel, e.g. "[kern] fill16: c 1.06 asm 0.53 cycles/px".
+// On ARM9 builds both versions are timed and their output is compared
+// ("MISMATCH" is appended if they differ). The geom.h helpers follow as
+// "[geom]" lines with before/after cycles per operation against the `/`
+// code their callers used. `dst` is the buffer under test
+// (VRAM on the DS) and needs room for KERNEL_BENCH_PIXELS + 2 pixels; its
+// contents are overwritten.
+void kernel_bench_run(uint16_t* dst, KernelBenchClock clock, KernelBenchLog log);
+
+#endif // KERNEL_BENCH_H
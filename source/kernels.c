@@ -0,0 +1,127 @@
+#include "kernels.h"
+
+// RGB15 channel masks: every channel without its lowest bit, and red + blue
+// apart from green
+#define KERNEL_HALF_MASK 0x7BDEu
+#define KERNEL_RB_MASK   0x7C1Fu
+#define KERNEL_G_MASK    0x03E0u
+#define KERNEL_ALPHA_BIT 0x8000u
+
+void kernel_fill16_c(uint16_t* dst, uint16_t color, int count) {
+    if (count <= 0) return;
+
+    if ((uintptr_t)dst & 2) {
+        *dst++ = color;
+        count--;
+    }
+
+    uint32_t pair = (uint32_t)color | ((uint32_t)color << 16);
+    uint32_t* dst32 = (uint32_t*)dst;
+    int words = count >> 1;
+
+    // Four words per iteration, the shape the compiler turns into STM
+    for (; words >= 4; words -= 4) {
+        dst32[0] = pair;
+        dst32[1] = pair;
+        dst32[2] = pair;
+        dst32[3] = pair;
+        dst32 += 4;
+    }
+    while (words-- > 0) {
+        *dst32++ = pair;
+    }
+
+    if (count & 1) {
+        *(uint16_t*)dst32 = color;
+    }
+}
+
+void kernel_copy16_c(uint16_t* dst, const uint16_t* src, int count) {
+    if (count <= 0) return;
+
+    // Word copies need both pointers on the same side of a word boundary
+    if ((((uintptr_t)dst ^ (uintptr_t)src) & 2) != 0) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = src[i];
+        }
+        return;
+    }
+
+    if ((uintptr_t)dst & 2) {
+        *dst++ = *src++;
+        count--;
+    }
+
+    uint32_t* dst32 = (uint32_t*)dst;
+    const uint32_t* src32 = (const uint32_t*)src;
+    int words = count >> 1;
+    for (int i = 0; i < words; i++) {
+        dst32[i] = src32[i];
+    }
+
+    if (count & 1) {
+        dst[count - 1] = src[count - 1];
+    }
+}
+
+void kernel_copy16_colorkey_c(uint16_t* dst, const uint16_t* src, int count, uint16_t key) {
+    for (int i = 0; i < count; i++) {
+        uint16_t color = src[i];
+        if (color != key) dst[i] = color;
+    }
+}
+
+// Per-channel floor average of two pixels (or two pixel pairs): the common
+// bits plus half the differing ones, with each channel's low bit masked off
+// so nothing shifts into the neighbouring channel
+static inline uint32_t kernel_average(uint32_t a, uint32_t b, uint32_t half_mask) {
+    return (a & b) + (((a ^ b) & half_mask) >> 1);
+}
+
+void kernel_blend50_c(uint16_t* dst, const uint16_t* src, int count) {
+    if (count <= 0) return;
+
+    if ((((uintptr_t)dst ^ (uintptr_t)src) & 2) == 0) {
+        if ((uintptr_t)dst & 2) {
+            *dst = (uint16_t)(kernel_average(*dst, *src, KERNEL_HALF_MASK) | KERNEL_ALPHA_BIT);
+            dst++;
+            src++;
+            count--;
+        }
+
+        // Two pixels per word; bit 15 is masked, so the halves stay apart
+        uint32_t* dst32 = (uint32_t*)dst;
+        const uint32_t* src32 = (const uint32_t*)src;
+        int words = count >> 1;
+        for (int i = 0; i < words; i++) {
+            dst32[i] = kernel_average(dst32[i], src32[i], KERNEL_HALF_MASK * 0x10001u) |
+                       (KERNEL_ALPHA_BIT * 0x10001u);
+        }
+        dst += words * 2;
+        src += words * 2;
+        count &= 1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        dst[i] = (uint16_t)(kernel_average(dst[i], src[i], KERNEL_HALF_MASK) | KERNEL_ALPHA_BIT);
+    }
+}
+
+// Spread a pixel so each channel has 10 bits of headroom: red at bit 0,
+// blue at bit 10, green at bit 21. A product with a weight <= 32 plus a
+// second such product cannot carry into the next channel.
+static inline uint32_t kernel_spread(uint32_t c) {
+    return (c & KERNEL_RB_MASK) | ((c & KERNEL_G_MASK) << 16);
+}
+
+void kernel_blend_n32_c(uint16_t* dst, const uint16_t* src, int count, int alpha) {
+    if (alpha < 0) alpha = 0;
+    if (alpha > KERNEL_ALPHA_MAX) alpha = KERNEL_ALPHA_MAX;
+    uint32_t a = (uint32_t)alpha;
+    uint32_t b = KERNEL_ALPHA_MAX - a;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t sum = (kernel_spread(src[i]) * a + kernel_spread(dst[i]) * b) >> 5;
+        dst[i] = (uint16_t)((sum & KERNEL_RB_MASK) | ((sum >> 16) & KERNEL_G_MASK) | KERNEL_ALPHA_BIT);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stdint.h>
+
+// Pixel kernels for the hot loops in graphics.c. Every kernel has a portable
+// C version (kernel_*_c) and, on ARM9, a hand-written ARMv5TE one
+// (kernel_*_arm, kernels_arm.s) that produces bit-identical output. The
+// unsuffixed names pick one at build time: make DEFINES="-DDESKEE_ASM_KERNELS=0"
+// forces the C versions on the DS.
+//
+// All kernels write VRAM-safe 16/32-bit stores only and accept any count
+// (<= 0 does nothing) and any halfword alignment.
+#ifndef DESKEE_ASM_KERNELS
+#ifdef ARM9
+#define DESKEE_ASM_KERNELS 1
+#else
+#define DESKEE_ASM_KERNELS 0
+#endif
+#endif
+
+#if DESKEE_ASM_KERNELS && !defined(ARM9)
+#error "DESKEE_ASM_KERNELS needs the ARM9 build"
+#endif
+
+// Opacity range of kernel_blend_n32
+#define KERNEL_ALPHA_MAX 32
+
+// dst[i] = color
+void kernel_fill16_c(uint16_t* dst, uint16_t color, int count);
+// dst[i] = src[i]
+void kernel_copy16_c(uint16_t* dst, const uint16_t* src, int count);
+// dst[i] = src[i] unless src[i] == key
+void kernel_copy16_colorkey_c(uint16_t* dst, const uint16_t* src, int count, uint16_t key);
+// dst[i] = per-channel floor((dst + src) / 2), alpha bit set
+void kernel_blend50_c(uint16_t* dst, const uint16_t* src, int count);
+// dst[i] = per-channel floor((src * alpha + dst * (32 - alpha)) / 32),
+// alpha bit set; alpha is clamped to [0, KERNEL_ALPHA_MAX]
+void kernel_blend_n32_c(uint16_t* dst, const uint16_t* src, int count, int alpha);
+
+// kernels_arm.s is always assembled for the DS, so the benchmark can time
+// both versions whichever one is selected
+#ifdef ARM9
+void kernel_fill16_arm(uint16_t* dst, uint16_t color, int count);
+void kernel_copy16_arm(uint16_t* dst, const uint16_t* src, int count);
+void kernel_copy16_colorkey_arm(uint16_t* dst, const uint16_t* src, int count, uint16_t key);
+void kernel_blend50_arm(uint16_t* dst, const uint16_t* src, int count);
+void kernel_blend_n32_arm(uint16_t* dst, const uint16_t* src, int count, int alpha);
+#endif
+
+#if DESKEE_ASM_KERNELS
+#define kernel_fill16 kernel_fill16_arm
+#define kernel_copy16 kernel_copy16_arm
+#define kernel_copy16_colorkey kernel_copy16_colorkey_arm
+#define kernel_blend50 kernel_blend50_arm
+#define kernel_blend_n32 kernel_blend_n32_arm
+#else
+#define kernel_fill16 kernel_fill16_c
+#define kernel_copy16 kernel_copy16_c
+#define kernel_copy16_colorkey kernel_copy16_colorkey_c
+#define kernel_blend50 kernel_blend50_c
+#define kernel_blend_n32 kernel_blend_n32_c
+#endif
+
+#endif // KERNELS_H
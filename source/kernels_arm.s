@@ -0,0 +1,229 @@
+@ ARMv5TE versions of the pixel kernels in kernels.c (see kernels.h for the
+@ contracts). Each one matches its C version bit for bit. Only halfword and
+@ word stores are used, so every kernel is safe on VRAM.
+
+    .syntax unified
+    .arm
+    .text
+    .align 2
+
+@ void kernel_fill16_arm(u16* dst, u16 color, int count)
+@ Aligns dst to a word, then stores 16 pixels per STMIA burst of 8 registers.
+    .global kernel_fill16_arm
+    .type   kernel_fill16_arm, %function
+kernel_fill16_arm:
+    cmp     r2, #0
+    bxle    lr
+    lsl     r1, r1, #16
+    orr     r1, r1, r1, lsr #16         @ color in both halves
+    tst     r0, #2
+    strhne  r1, [r0], #2
+    subne   r2, r2, #1
+
+    push    {r4-r9}
+    mov     r3, r1
+    mov     r4, r1
+    mov     r5, r1
+    mov     r6, r1
+    mov     r7, r1
+    mov     r8, r1
+    mov     r9, r1
+    subs    r2, r2, #16
+    blt     2f
+1:  stmia   r0!, {r1, r3-r9}
+    subs    r2, r2, #16
+    bge     1b
+
+    @ 0-15 pixels left; the low four bits of r2 still hold that count
+2:  tst     r2, #8
+    stmiane r0!, {r1, r3-r5}
+    tst     r2, #4
+    stmiane r0!, {r1, r3}
+    tst     r2, #2
+    strne   r1, [r0], #4
+    tst     r2, #1
+    strhne  r1, [r0]
+    pop     {r4-r9}
+    bx      lr
+    .size   kernel_fill16_arm, . - kernel_fill16_arm
+
+@ void kernel_copy16_arm(u16* dst, const u16* src, int count)
+@ 8-register LDMIA/STMIA bursts when both pointers share word alignment,
+@ halfword pairs otherwise.
+    .global kernel_copy16_arm
+    .type   kernel_copy16_arm, %function
+kernel_copy16_arm:
+    cmp     r2, #0
+    bxle    lr
+    eor     r3, r0, r1
+    tst     r3, #2
+    bne     .Lcopy_halves
+    tst     r0, #2
+    ldrhne  r3, [r1], #2
+    strhne  r3, [r0], #2
+    subne   r2, r2, #1
+
+    push    {r4-r10}
+    subs    r2, r2, #16
+    blt     2f
+1:  ldmia   r1!, {r3-r10}
+    stmia   r0!, {r3-r10}
+    subs    r2, r2, #16
+    bge     1b
+
+2:  tst     r2, #8
+    ldmiane r1!, {r3-r6}
+    stmiane r0!, {r3-r6}
+    tst     r2, #4
+    ldmiane r1!, {r3-r4}
+    stmiane r0!, {r3-r4}
+    tst     r2, #2
+    ldrne   r3, [r1], #4
+    strne   r3, [r0], #4
+    tst     r2, #1
+    ldrhne  r3, [r1]
+    strhne  r3, [r0]
+    pop     {r4-r10}
+    bx      lr
+
+.Lcopy_halves:
+    subs    r2, r2, #2
+    blt     4f
+3:  ldrh    r3, [r1], #2
+    ldrh    ip, [r1], #2
+    strh    r3, [r0], #2
+    strh    ip, [r0], #2
+    subs    r2, r2, #2
+    bge     3b
+4:  tst     r2, #1
+    ldrhne  r3, [r1]
+    strhne  r3, [r0]
+    bx      lr
+    .size   kernel_copy16_arm, . - kernel_copy16_arm
+
+@ void kernel_copy16_colorkey_arm(u16* dst, const u16* src, int count, u16 key)
+@ Two pixels per iteration so each load has a free slot before its compare.
+    .global kernel_copy16_colorkey_arm
+    .type   kernel_copy16_colorkey_arm, %function
+kernel_copy16_colorkey_arm:
+    cmp     r2, #0
+    bxle    lr
+    lsl     r3, r3, #16
+    lsr     r3, r3, #16
+    push    {r4}
+    subs    r2, r2, #2
+    blt     2f
+1:  ldrh    ip, [r1], #2
+    ldrh    r4, [r1], #2
+    cmp     ip, r3
+    strhne  ip, [r0]
+    cmp     r4, r3
+    strhne  r4, [r0, #2]
+    add     r0, r0, #4
+    subs    r2, r2, #2
+    bge     1b
+2:  tst     r2, #1
+    beq     3f
+    ldrh    ip, [r1]
+    cmp     ip, r3
+    strhne  ip, [r0]
+3:  pop     {r4}
+    bx      lr
+    .size   kernel_copy16_colorkey_arm, . - kernel_copy16_colorkey_arm
+
+@ Blend the pixel(s) in \a with \b into \out: (a & b) + (((a ^ b) & r6) >> 1),
+@ alpha set from lr. Works on one pixel or two packed in a word.
+.macro BLEND50 out, a, b, tmp
+    and     \out, \a, \b
+    eor     \tmp, \a, \b
+    and     \tmp, \tmp, r6
+    add     \out, \out, \tmp, lsr #1
+    orr     \out, \out, lr
+.endm
+
+@ void kernel_blend50_arm(u16* dst, const u16* src, int count)
+@ Two pixels per word when the pointers share word alignment.
+    .global kernel_blend50_arm
+    .type   kernel_blend50_arm, %function
+kernel_blend50_arm:
+    cmp     r2, #0
+    bxle    lr
+    push    {r4-r7, lr}
+    ldr     r6, =0x7BDE7BDE             @ channels without their low bit
+    ldr     lr, =0x80008000             @ alpha bits
+    eor     r3, r0, r1
+    tst     r3, #2
+    bne     .Lblend50_halves
+
+    tst     r0, #2
+    beq     1f
+    ldrh    r3, [r0]
+    ldrh    r4, [r1], #2
+    BLEND50 r5, r3, r4, r7
+    strh    r5, [r0], #2
+    sub     r2, r2, #1
+
+1:  subs    r2, r2, #2
+    blt     3f
+2:  ldr     r3, [r0]
+    ldr     r4, [r1], #4
+    BLEND50 r5, r3, r4, r7
+    str     r5, [r0], #4
+    subs    r2, r2, #2
+    bge     2b
+3:  tst     r2, #1
+    beq     5f
+    ldrh    r3, [r0]
+    ldrh    r4, [r1]
+    BLEND50 r5, r3, r4, r7
+    strh    r5, [r0]
+    b       5f
+
+.Lblend50_halves:
+4:  ldrh    r3, [r0]
+    ldrh    r4, [r1], #2
+    BLEND50 r5, r3, r4, r7
+    strh    r5, [r0], #2
+    subs    r2, r2, #1
+    bgt     4b
+5:  pop     {r4-r7, pc}
+    .size   kernel_blend50_arm, . - kernel_blend50_arm
+
+@ void kernel_blend_n32_arm(u16* dst, const u16* src, int count, int alpha)
+@ Spreads each pixel to red at bit 0, blue at 10 and green at 21 so one MUL
+@ and one MLA weight all three channels without carries between them.
+    .global kernel_blend_n32_arm
+    .type   kernel_blend_n32_arm, %function
+kernel_blend_n32_arm:
+    cmp     r2, #0
+    bxle    lr
+    push    {r4-r8, lr}
+    cmp     r3, #0
+    movlt   r3, #0
+    cmp     r3, #32
+    movgt   r3, #32
+    rsb     r4, r3, #32                 @ weight of dst
+    ldr     r5, =0x7C1F                 @ red + blue
+    mov     r6, #0x3E0                  @ green
+
+1:  ldrh    r7, [r1], #2
+    ldrh    r8, [r0]
+    and     ip, r7, r6
+    and     r7, r7, r5
+    orr     r7, r7, ip, lsl #16
+    and     ip, r8, r6
+    and     r8, r8, r5
+    orr     r8, r8, ip, lsl #16
+    mul     ip, r7, r3
+    mla     ip, r8, r4, ip
+    and     r7, r5, ip, lsr #5
+    and     r8, r6, ip, lsr #21
+    orr     r7, r7, r8
+    orr     r7, r7, #0x8000
+    strh    r7, [r0], #2
+    subs    r2, r2, #1
+    bgt     1b
+    pop     {r4-r8, pc}
+    .size   kernel_blend_n32_arm, . - kernel_blend_n32_arm
+
+    .ltorg
@@ -2,14 +2,91 @@
 #include <stdio.h>
 #include <time.h>
 
+#include "font.h"
 #include "graphics.h"
 #include "grid.h"
+#include "idle.h"
+#include "kernel_bench.h"
+#include "profile.h"
+#include "time_service.h"
+#include "tz.h"
 #include "widgets/widget.h"
 #include "widgets/widget_clock.h"
+#include "widgets/widget_digital_clock.h"
 #include "widgets/widget_calendar.h"
 #include "widgets/widget_visualizer.h"
 #include "widgets/widget_battery.h"
 #include "widgets/widget_draw.h"
+#include "widgets/widget_scheduler.h"
+#include "widgets/widget_world_clock.h"
+
+// Render the top screen into VRAM_B/VRAM_A alternately and flip on VBlank
+#ifndef DESKEE_TOP_DOUBLE_BUFFER
+#define DESKEE_TOP_DOUBLE_BUFFER 1
+#endif
+
+// Both screens are 256x256 Bmp16 backgrounds showing 256x192 of content
+#define SCREEN_WIDTH 256
+#define SCREEN_HEIGHT 192
+#define BG_BITMAP_HEIGHT 256
+
+// Bitmap base (16 KiB units) of VRAM_B when mapped at 0x06020000
+#define TOP_BACK_MAP_BASE 8
+
+// Scanlines per frame, VBlank included. The loop wakes when VBlank starts
+// and a frame is late once APP_LATE_LINES of them have gone by.
+#define APP_FRAME_LINES 263
+#define APP_LATE_LINES 200
+
+// Log per-frame draw/present timings to the emulator console every N frames
+#ifndef DESKEE_PROFILE
+#define DESKEE_PROFILE 0
+#endif
+#define PROFILE_REPORT_FRAMES 300
+
+// Record each screen's drawing into a display list and execute it once per
+// frame, skipping overdrawn fills: make DEFINES="-DDESKEE_COMMAND_BUFFER=1"
+#ifndef DESKEE_COMMAND_BUFFER
+#define DESKEE_COMMAND_BUFFER 0
+#endif
+#define COMMAND_ARENA_WORDS 8192
+
+#if DESKEE_COMMAND_BUFFER
+static u32 top_command_arena[COMMAND_ARENA_WORDS];
+static u32 bottom_command_arena[COMMAND_ARENA_WORDS];
+#endif
+
+// Cached main-RAM render targets for shadow mode (toggled with SELECT)
+static u16 top_shadow[SCREEN_WIDTH * SCREEN_HEIGHT] ALIGN(32);
+static u16 bottom_shadow[SCREEN_WIDTH * SCREEN_HEIGHT] ALIGN(32);
+
+// Pre-rendered clock face; ticks restore the old hands from it
+static u16 clock_face_cache[SCREEN_WIDTH * SCREEN_HEIGHT] ALIGN(32);
+
+// Zone the DS clock is set in; the RTC has no zone of its own:
+// make DEFINES='-DDESKEE_HOME_ZONE=\"Tokyo\"'
+#ifndef DESKEE_HOME_ZONE
+#define DESKEE_HOME_ZONE "UTC"
+#endif
+
+// Seconds without input before the app goes idle (0 = only when the lid
+// closes): make DEFINES="-DDESKEE_IDLE_SECONDS=300"
+#ifndef DESKEE_IDLE_SECONDS
+#define DESKEE_IDLE_SECONDS 120
+#endif
+
+// Every widget instance has a slot; the grid holds at most as many
+#define APP_MAX_WIDGETS GRID_MAX_ITEMS
+
+// Cities of the world clock row, one cell each
+#define APP_WORLD_CLOCKS 5
+static const char* const app_world_cities[APP_WORLD_CLOCKS] = {
+    "Los Angeles", "New York", "London", "Tokyo", "Sydney",
+};
+
+// VBlanks since boot, counted in the interrupt so frames the main loop
+// misses under load still reach the time service and wake timers
+static volatile u32 app_vblank_count;
 
 typedef enum {
     THEME_LIGHT,
@@ -21,25 +98,48 @@ typedef struct {
     RotationAngle rotation;
     GraphicsContext gfx_top;
     GraphicsContext gfx_bottom;
+    GfxCommandList top_commands;
+    GfxCommandList bottom_commands;
     GridLayout grid;
-    int clock_slot;
-    int calendar_slot;
-    int visualizer_slot;
-    int battery_slot;
-    int draw_slot;
-    Widget clock_widget;
+    // Widget instances in tick and update order; each points at one of the
+    // states below
+    Widget widgets[APP_MAX_WIDGETS];
+    int widget_count;
+    Widget* clock_widget;     // Woken after clock config changes
     ClockWidgetState clock_state;
-    Widget calendar_widget;
+    DigitalClockWidgetState digital_state;
     CalendarWidgetState calendar_state;
-    Widget visualizer_widget;
     VisualizerWidgetState visualizer_state;
-    Widget battery_widget;
     BatteryWidgetState battery_state;
-    Widget draw_widget;
     DrawWidgetState draw_state;
-    int last_second;
+    WorldClockWidgetState world_states[APP_WORLD_CLOCKS];
+    // RTC time and its UTC reading, shared by every widget
+    TimeService time;
+    unsigned forced_changes;  // TimeChange bits delivered on the next frame
+    u32 vblank_seen;          // app_vblank_count at the last frame
+    bool behind;              // The previous frame ran past a VBlank
+    bool late;                // The governor held work back this frame
+    int idle_frames;          // Frames where no widget woke, for the profile report
+    int late_frames;          // Frames the governor reported as late
+    // Idle mode: screens dark, mic off, widget updates held and time
+    // changes delivered once a minute
+    IdleMonitor idle;
+    unsigned idle_changes;    // TimeChange bits held back while idle
+    bool wake_hold;           // Ignore the input that woke the app until released
+    bool idle_woke;           // Measure the redraw of the first frame after waking
+    int wake_pixels;          // Pixels drawn in that frame
+    bool shadow;
+    bool hw_rotation;     // Rotate whole screens with the BG affine matrix
+    bool bg_dirty;        // Background registers need a bgUpdate() at VBlank
+    u16* top_buffers[2];  // VRAM_A and VRAM_B views of the top background
+    ProfileCounter draw_time;
+    ProfileCounter present_time;
+    ProfileCounter idle_enter_time;
+    ProfileCounter idle_leave_time;
+    int profile_frames;
 } AppContext;
 
+static int top_bg_id = -1;
 static int bottom_bg_id = -1;
 
 static WidgetTheme app_widget_theme(const AppContext* app) {
@@ -50,8 +150,57 @@ static void app_set_rotation(AppContext* app, RotationAngle rotation);
 static void app_apply_theme(AppContext* app);
 static void app_apply_full_layout(AppContext* app);
 
+// Tick every widget on the next frame, whatever it subscribed to
 static void app_force_time_refresh(AppContext* app) {
-    app->last_second = -1;
+    app->forced_changes = TIME_CHANGE_ALL;
+}
+
+// Take the next widget slot and place it on the grid; NULL when the slots
+// run out or the cells are taken
+static Widget* app_add_widget(AppContext* app, int grid_w, int grid_h, int grid_x, int grid_y) {
+    if (app->widget_count >= APP_MAX_WIDGETS) return NULL;
+
+    Widget* widget = &app->widgets[app->widget_count];
+    if (grid_add_widget(&app->grid, widget, grid_w, grid_h, grid_x, grid_y, false) < 0) return NULL;
+    app->widget_count++;
+    return widget;
+}
+
+static void app_set_widget_rotation(AppContext* app, RotationAngle rotation) {
+    for (int i = 0; i < app->widget_count; ++i) {
+        widget_set_rotation(&app->widgets[i], rotation);
+    }
+}
+
+// Rotation the widgets apply in software; hardware mode leaves them upright
+static RotationAngle app_widget_rotation(const AppContext* app) {
+    return app->hw_rotation ? ROTATION_0 : app->rotation;
+}
+
+// Program the affine matrix of both backgrounds. Takes effect at the next
+// VBlank and never touches a pixel.
+static void app_apply_bg_rotation(AppContext* app) {
+    RotationAngle rotation = app->hw_rotation ? app->rotation : ROTATION_0;
+    // The matrix maps screen to texture space, so turning the picture
+    // clockwise needs the opposite angle
+    int angle = degreesToAngle(((4 - (int)rotation) % 4) * 90);
+    int bgs[2] = {top_bg_id, bottom_bg_id};
+
+    for (int i = 0; i < 2; ++i) {
+        if (bgs[i] < 0) continue;
+        bgSetCenter(bgs[i], SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+        bgSetScroll(bgs[i], SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+        bgSetRotateScale(bgs[i], angle, 1 << 8, 1 << 8);
+    }
+    app->bg_dirty = true;
+}
+
+// Make the bitmap rows below the visible area transparent; quarter turns
+// bring them on screen, where the backdrop should show instead
+static void app_clear_offscreen_rows(u16* buffer) {
+    if (!buffer) return;
+    dmaFillWords(0, buffer + SCREEN_WIDTH * SCREEN_HEIGHT,
+                 SCREEN_WIDTH * (BG_BITMAP_HEIGHT - SCREEN_HEIGHT) * sizeof(u16));
 }
 
 static void app_apply_theme(AppContext* app) {
@@ -63,14 +212,14 @@ static void app_apply_theme(AppContext* app) {
         /* Also clear bottom framebuffer so areas outside widgets use the theme background
            (prevents leftover black from the bitmap background). */
         gfx_clear(&app->gfx_bottom, clock_theme->background);
-        bgUpdate();
+        /* The backdrop fills whatever a rotated background leaves uncovered. */
+        BG_PALETTE[0] = clock_theme->background;
+        BG_PALETTE_SUB[0] = clock_theme->background;
     }
 
-    widget_set_theme(&app->clock_widget, widget_theme);
-    widget_set_theme(&app->calendar_widget, widget_theme);
-    widget_set_theme(&app->visualizer_widget, widget_theme);
-    widget_set_theme(&app->battery_widget, widget_theme);
-    widget_set_theme(&app->draw_widget, widget_theme);
+    for (int i = 0; i < app->widget_count; ++i) {
+        widget_set_theme(&app->widgets[i], widget_theme);
+    }
 
     app_force_time_refresh(app);
 }
@@ -79,22 +228,65 @@ static void app_set_rotation(AppContext* app, RotationAngle rotation) {
     if (app->rotation == rotation) return;
 
     app->rotation = rotation;
-    widget_set_rotation(&app->clock_widget, rotation);
-    widget_set_rotation(&app->calendar_widget, rotation);
-    widget_set_rotation(&app->visualizer_widget, rotation);
-    widget_set_rotation(&app->battery_widget, rotation);
-    widget_set_rotation(&app->draw_widget, rotation);
+    if (app->hw_rotation) {
+        app_apply_bg_rotation(app);
+        return;
+    }
+
+    app_set_widget_rotation(app, rotation);
 
     app_apply_full_layout(app);
     app_apply_theme(app);
 }
 
+// Physical rect a widget covers when it turns the cell (x, y, w, h) about
+// its center, as widgets do with gfx_set_transform. A quarter turn swaps the
+// sides, so a non-square widget overhangs its cell on two of them.
+static void app_rotated_cell(RotationAngle rotation, int* x, int* y, int* w, int* h) {
+    int x0 = *x;
+    int y0 = *y;
+    int x1 = *x + *w - 1;
+    int y1 = *y + *h - 1;
+    int cx = *x + *w / 2;
+    int cy = *y + *h / 2;
+
+    switch (rotation) {
+        case ROTATION_90:
+            *x = cx + cy - y1;
+            *y = cy - cx + x0;
+            break;
+        case ROTATION_180:
+            *x = 2 * cx - x1;
+            *y = 2 * cy - y1;
+            return;
+        case ROTATION_270:
+            *x = cx - cy + y0;
+            *y = cx + cy - x1;
+            break;
+        default:
+            return;
+    }
+
+    int t = *w;
+    *w = *h;
+    *h = t;
+}
+
 static void app_apply_grid_item(AppContext* app, GridItem* item) {
     if (!app || !item || !item->widget) return;
 
     GridScreen screen = grid_item_screen(item);
     GraphicsContext* target = (screen == GRID_SCREEN_TOP) ? &app->gfx_top : &app->gfx_bottom;
 
+    int x = 0, y = 0, w = 0, h = 0;
+    grid_item_screen_rect(&app->grid, item, &x, &y, &w, &h);
+
+    // Keep the widget inside its cell, turned the way the widget turns its
+    // content, before anything below can redraw it
+    int clip_x = x, clip_y = y, clip_w = w, clip_h = h;
+    app_rotated_cell(app_widget_rotation(app), &clip_x, &clip_y, &clip_w, &clip_h);
+    widget_set_clip(item->widget, clip_x, clip_y, clip_w, clip_h);
+
     if (widget_context(item->widget) != target) {
         if (widget_context(item->widget)) {
             widget_detach(item->widget);
@@ -102,68 +294,9 @@ static void app_apply_grid_item(AppContext* app, GridItem* item) {
         widget_attach(item->widget, target);
     }
 
-    widget_set_rotation(item->widget, app->rotation);
-
-    int x = 0, y = 0, w = 0, h = 0;
-    grid_item_screen_rect(&app->grid, item, &x, &y, &w, &h);
+    widget_set_rotation(item->widget, app_widget_rotation(app));
 
-    if (item->widget == &app->clock_widget) {
-        int margin = (w > 40 && h > 40) ? 2 : 0;
-        int bx = x + margin;
-        int by = y + margin;
-        int bw = w - margin * 2;
-        int bh = h - margin * 2;
-        if (bw <= 0 || bh <= 0) {
-            bx = x;
-            by = y;
-            bw = w;
-            bh = h;
-        }
-        widget_clock_set_bounds(&app->clock_state, bx, by, bw, bh);
-    } else if (item->widget == &app->calendar_widget) {
-        int margin = (w > 40 && h > 40) ? 2 : 0;
-        int bx = x + margin;
-        int by = y + margin;
-        int bw = w - margin * 2;
-        int bh = h - margin * 2;
-        if (bw <= 0 || bh <= 0) {
-            bx = x;
-            by = y;
-            bw = w;
-            bh = h;
-        }
-        widget_calendar_set_bounds(&app->calendar_state, bx, by, bw, bh);
-    } else if (item->widget == &app->visualizer_widget) {
-        int margin = (w > 32 && h > 32) ? 2 : 0;
-        int bx = x + margin;
-        int by = y + margin;
-        int bw = w - margin * 2;
-        int bh = h - margin * 2;
-        if (bw <= 0) {
-            bx = x;
-            bw = w;
-        }
-        if (bh <= 0) {
-            by = y;
-            bh = h;
-        }
-        widget_visualizer_set_bounds(&app->visualizer_state, bx, by, bw, bh);
-    } else if (item->widget == &app->battery_widget) {
-        int margin = (w > 40 && h > 40) ? 2 : 0;
-        int bw = w - margin * 2;
-        int bh = h - margin * 2;
-        int bx = x + margin;
-        int by = y + margin;
-        if (bw <= 0 || bh <= 0) {
-            bx = x;
-            by = y;
-            bw = w;
-            bh = h;
-        }
-        widget_battery_set_bounds(&app->battery_state, bx, by, bw, bh);
-    } else if (item->widget == &app->draw_widget) {
-        widget_draw_set_bounds(&app->draw_state, x, y, w, h);
-    }
+    widget_set_bounds(item->widget, x, y, w, h);
 
     widget_set_split_mode(item->widget, screen == GRID_SCREEN_BOTTOM);
 }
@@ -181,55 +314,338 @@ static void app_toggle_theme(AppContext* app) {
     app_apply_theme(app);
 }
 
-static void app_handle_time_tick(AppContext* app, struct tm* timeinfo) {
-    if (!timeinfo) return;
+// Tick the widgets subscribed to any of the `changed` bits
+static void app_handle_time_tick(AppContext* app, unsigned changed) {
+    for (int i = 0; i < app->widget_count; ++i) {
+        widget_time_tick(&app->widgets[i], &app->time.local, changed);
+    }
+}
+
+// Frame governor: late when the previous frame overran, when a VBlank has
+// already passed since this one began, or when the scanline counter is past
+// APP_LATE_LINES. Low-priority widget updates then wait for a later frame.
+static bool app_frame_late(void* context) {
+    AppContext* app = context;
+    int lines = REG_VCOUNT - SCREEN_HEIGHT;
+    if (lines < 0) lines += APP_FRAME_LINES;
+
+    bool late = app->behind || app_vblank_count != app->vblank_seen || lines >= APP_LATE_LINES;
+    if (late && !app->late) app->late_frames++;
+    app->late |= late;
+    return late;
+}
+
+// Run the widgets with a pending wake source; returns how many ran
+static int app_update_widgets(AppContext* app, int frames) {
+    return widget_scheduler_run(app->widgets, app->widget_count, frames, app_frame_late, app);
+}
+
+// While idle, widget updates wait, but a redraw a time tick started must not
+// hold its screen back until input: finish it now, slices back to back
+static int app_finish_redraws(AppContext* app) {
+    int ran = 0;
+    for (int i = 0; i < app->widget_count; ++i) {
+        Widget* widget = &app->widgets[i];
+        while (widget->wake_pending & WIDGET_WAKE_RESUME) {
+            widget->wake_pending &= ~WIDGET_WAKE_RESUME;
+            widget->wake_reasons = WIDGET_WAKE_RESUME;
+            widget_update(widget);
+            widget->wake_reasons = 0;
+            ran++;
+        }
+    }
+    return ran;
+}
+
+static void app_vblank_irq(void) {
+    app_vblank_count++;
+}
+
+// Shed background work: the microphone stops, widget updates wait and time
+// changes are held to once a minute. The screens fade out on their own.
+static void app_enter_idle(AppContext* app) {
+    if (app->idle.level == IDLE_DEEP) return;
+
+    u32 start = profile_ticks();
+    idle_enter(&app->idle);
+    widget_visualizer_set_mic_paused(&app->visualizer_state, true);
+    profile_counter_add(&app->idle_enter_time, profile_ticks() - start);
+}
+
+// Bring the screens and the mic back. Widgets catch up on the time changes
+// held back while idle, which redraws only what changed.
+static void app_leave_idle(AppContext* app) {
+    if (app->idle.level == IDLE_ACTIVE) return;
+
+    u32 start = profile_ticks();
+    idle_leave(&app->idle, app_vblank_count);
+    widget_visualizer_set_mic_paused(&app->visualizer_state, false);
+    app->forced_changes |= app->idle_changes;
+    app->idle_changes = 0;
+    app->wake_hold = true;
+    app->idle_woke = true;
+    profile_counter_add(&app->idle_leave_time, profile_ticks() - start);
+}
+
+// While idle, hold time changes back until a minute passes, then deliver
+// everything gathered since. Each bit implies the smaller ones, so widgets
+// see one ordinary tick.
+static unsigned app_idle_time_changes(AppContext* app, unsigned changed) {
+    if (app->idle.level == IDLE_ACTIVE) return changed;
+
+    app->idle_changes |= changed;
+    if (!(app->idle_changes & TIME_CHANGE_MINUTE)) return 0;
+
+    changed = app->idle_changes;
+    app->idle_changes = 0;
+    return changed;
+}
+
+// Area of the damage rects of a screen this frame
+static int app_damage_pixels(const GraphicsContext* ctx) {
+    int pixels = 0;
+    for (int i = 0; i < gfx_damage_count(ctx); ++i) {
+        const GfxRect* rect = gfx_damage_get(ctx, i);
+        pixels += rect->width * rect->height;
+    }
+    return pixels;
+}
+
+// True while a widget drawing into `ctx` is partway through a sliced redraw
+static bool app_redraw_pending(AppContext* app, GraphicsContext* ctx) {
+    for (int i = 0; i < app->widget_count; ++i) {
+        Widget* widget = &app->widgets[i];
+        if (widget_context(widget) == ctx && (widget->wake_pending & WIDGET_WAKE_RESUME)) return true;
+    }
+    return false;
+}
+
+// Queue a screen's frame unless a sliced redraw would show half drawn. A held
+// screen keeps its damage, so the frame that finishes the redraw presents it all.
+static void app_present_screen(AppContext* app, GraphicsContext* ctx) {
+    if (app_redraw_pending(app, ctx)) return;
 
-    widget_time_tick(&app->clock_widget, timeinfo);
-    widget_time_tick(&app->calendar_widget, timeinfo);
-    widget_time_tick(&app->battery_widget, timeinfo);
+    gfx_queue_present(ctx);
+    if (ctx == &app->gfx_bottom && gfx_damage_count(ctx) > 0) {
+        app->bg_dirty = true;
+    }
+    gfx_damage_clear(ctx);
+}
+
+// Flush each screen at most once per frame, and only if something was drawn
+static void app_present_frame(AppContext* app) {
+    // Draw the recorded display lists (no-op when drawing immediately)
+    gfx_execute_commands(&app->gfx_top);
+    gfx_execute_commands(&app->gfx_bottom);
+
+    if (app->idle_woke) {
+        app->wake_pixels = app_damage_pixels(&app->gfx_top) + app_damage_pixels(&app->gfx_bottom);
+        app->idle_woke = false;
+    }
+
+    app_present_screen(app, &app->gfx_top);
+    app_present_screen(app, &app->gfx_bottom);
+}
+
+// Show what was finished last frame. Must run right after VBlank.
+static void app_present_vblank(AppContext* app) {
+    if (gfx_flip(&app->gfx_top)) {
+        bgSetMapBase(top_bg_id, app->gfx_top.front_buffer == app->top_buffers[0] ? 0 : TOP_BACK_MAP_BASE);
+        gfx_sync_back_buffer(&app->gfx_top);
+    }
+
+    gfx_upload_shadow(&app->gfx_top);
+    gfx_upload_shadow(&app->gfx_bottom);
+
+    if (app->bg_dirty) {
+        bgUpdate();
+        app->bg_dirty = false;
+    }
+}
+
+static void app_reset_profile(AppContext* app) {
+    profile_counter_reset(&app->draw_time);
+    profile_counter_reset(&app->present_time);
+    profile_counter_reset(&app->idle_enter_time);
+    profile_counter_reset(&app->idle_leave_time);
+    profile_counter_reset(&app->clock_state.hands_time);
+    profile_counter_reset(&app->clock_state.sweep_time);
+    gfx_command_stats_reset(&app->top_commands);
+    gfx_command_stats_reset(&app->bottom_commands);
+    app->time.reads = 0;
+    for (int i = 0; i < app->widget_count; ++i) {
+        app->widgets[i].wakeups = 0;
+        app->widgets[i].max_cycles = 0;
+        app->widgets[i].overruns = 0;
+        app->widgets[i].deferrals = 0;
+    }
+    app->idle_frames = 0;
+    app->late_frames = 0;
+    app->profile_frames = 0;
+}
+
+#if DESKEE_PROFILE && DESKEE_COMMAND_BUFFER
+static void app_log_commands(const GfxCommandList* list, const char* screen) {
+    const GfxCommandStats* stats = &list->stats;
+    char line[128];
+    snprintf(line, sizeof(line), "[cmds] %s: %d recorded, %d merged, %d culled, %d px filled, %d flushes",
+             screen, stats->recorded, stats->merged, stats->culled, stats->pixels, stats->flushes);
+    nocashMessage(line);
+}
+#endif
+
+#if DESKEE_PROFILE
+// Wakeups per second of each widget (ticks and updates), in tenths, and
+// the share of frames where nothing woke
+static void app_log_wakeups(const AppContext* app) {
+    char line[64];
+    for (int i = 0; i < app->widget_count; ++i) {
+        const Widget* widget = &app->widgets[i];
+        u32 tenths = widget->wakeups * TIME_SERVICE_FRAMES_PER_SECOND * 10 / (u32)app->profile_frames;
+        snprintf(line, sizeof(line), "[wake] %s: %lu.%lu/s", widget->name, (unsigned long)(tenths / 10),
+                 (unsigned long)(tenths % 10));
+        nocashMessage(line);
+    }
+    snprintf(line, sizeof(line), "[wake] idle: %d of %d frames", app->idle_frames, app->profile_frames);
+    nocashMessage(line);
+}
+
+// Longest callback of each widget against its budget, and what the
+// governor held back
+static void app_log_budgets(const AppContext* app) {
+    char line[64];
+    for (int i = 0; i < app->widget_count; ++i) {
+        const Widget* widget = &app->widgets[i];
+        if (widget->budget_cycles == 0) continue;
+        snprintf(line, sizeof(line), "[budget] %s: max %lu/%lu, %lu over, %lu deferred", widget->name,
+                 (unsigned long)widget->max_cycles, (unsigned long)widget->budget_cycles,
+                 (unsigned long)widget->overruns, (unsigned long)widget->deferrals);
+        nocashMessage(line);
+    }
+    snprintf(line, sizeof(line), "[budget] late: %d of %d frames", app->late_frames, app->profile_frames);
+    nocashMessage(line);
+}
+#endif
+
+static void app_report_profile(AppContext* app) {
+#if DESKEE_PROFILE
+    if (++app->profile_frames < PROFILE_REPORT_FRAMES) return;
+
+    const char* mode = app->shadow ? "[shadow]"
+                                   : (app->gfx_top.front_buffer ? "[double]" : "[direct]");
+    profile_counter_log(&app->draw_time, mode);
+    profile_counter_log(&app->present_time, mode);
+    const char* hands = app->clock_state.config.antialias ? "[aa]" : "[aliased]";
+    profile_counter_log(&app->clock_state.hands_time, hands);
+    profile_counter_log(&app->clock_state.sweep_time, hands);
+    char line[64];
+    snprintf(line, sizeof(line), "[time] %d RTC reads in %d frames", app->time.reads, app->profile_frames);
+    nocashMessage(line);
+    app_log_wakeups(app);
+    app_log_budgets(app);
+    if (app->idle_leave_time.samples > 0) {
+        profile_counter_log(&app->idle_enter_time, "[idle]");
+        profile_counter_log(&app->idle_leave_time, "[idle]");
+        snprintf(line, sizeof(line), "[idle] wake frame drew %d px", app->wake_pixels);
+        nocashMessage(line);
+    }
+#if DESKEE_COMMAND_BUFFER
+    app_log_commands(&app->top_commands, "top");
+    app_log_commands(&app->bottom_commands, "bottom");
+#endif
+    app_reset_profile(app);
+#else
+    (void)app;
+#endif
+}
+
+#if DESKEE_PROFILE
+static uint32_t app_bench_cycles(void) {
+    return profile_ticks() * PROFILE_CYCLES_PER_TICK;
+}
+#endif
+
+// Switch both screens between drawing into VRAM and into cached shadow
+// surfaces; compare the two with DESKEE_PROFILE builds
+static void app_set_shadow(AppContext* app, bool enabled) {
+    if (app->shadow == enabled) return;
+    app->shadow = enabled;
+
+    if (enabled) {
+        gfx_enable_shadow(&app->gfx_top, top_shadow);
+        gfx_enable_shadow(&app->gfx_bottom, bottom_shadow);
+    } else {
+        gfx_disable_shadow(&app->gfx_top);
+        gfx_disable_shadow(&app->gfx_bottom);
+#if DESKEE_TOP_DOUBLE_BUFFER
+        u16* shown = app->gfx_top.framebuffer;
+        u16* hidden = (shown == app->top_buffers[0]) ? app->top_buffers[1] : app->top_buffers[0];
+        gfx_enable_double_buffer(&app->gfx_top, shown, hidden);
+#endif
+    }
+
+    app_reset_profile(app);
+}
 
-    app->last_second = timeinfo->tm_sec;
+// Switch between per-widget software rotation and whole-screen hardware
+// rotation. Only the switch itself redraws; B/X in hardware mode do not.
+static void app_set_hw_rotation(AppContext* app, bool enabled) {
+    if (app->hw_rotation == enabled) return;
+    app->hw_rotation = enabled;
+
+    app_set_widget_rotation(app, app_widget_rotation(app));
+
+    app_apply_bg_rotation(app);
+    app_apply_full_layout(app);
+    app_apply_theme(app);
 }
 
-static void app_update_widgets(AppContext* app) {
-    widget_update(&app->clock_widget);
-    widget_update(&app->calendar_widget);
-    widget_update(&app->visualizer_widget);
-    widget_update(&app->battery_widget);
-    widget_update(&app->draw_widget);
+// Switch every world clock between small analog faces and digital time
+static void app_toggle_world_style(AppContext* app) {
+    for (int i = 0; i < APP_WORLD_CLOCKS; ++i) {
+        WorldClockWidgetState* state = &app->world_states[i];
+        widget_world_clock_set_style(state, state->style == WORLD_CLOCK_ANALOG ? WORLD_CLOCK_DIGITAL
+                                                                                 : WORLD_CLOCK_ANALOG);
+    }
+    app_force_time_refresh(app);
 }
 
 static void app_init_widgets(AppContext* app) {
     if (!app) return;
 
-    widget_clock_init(&app->clock_widget, &app->clock_state);
-    widget_calendar_init(&app->calendar_widget, &app->calendar_state);
-    widget_visualizer_init(&app->visualizer_widget, &app->visualizer_state);
-    widget_battery_init(&app->battery_widget, &app->battery_state);
-    widget_draw_init(&app->draw_widget, &app->draw_state);
-
     grid_init(&app->grid, app->gfx_top.width, app->gfx_top.height);
 
-    app->clock_slot = grid_add_widget(&app->grid, &app->clock_widget, 2, 2, 0, 0, false);
-    app->calendar_slot = grid_add_widget(&app->grid, &app->calendar_widget, 2, 2, 2, 0, false);
-    app->battery_slot = grid_add_widget(&app->grid, &app->battery_widget, 1, 2, 4, 0, false);
-    app->visualizer_slot = grid_add_widget(&app->grid, &app->visualizer_widget, 5, 2, 0, 2, false);
-    app->draw_slot = grid_add_widget(&app->grid, &app->draw_widget, 5, GRID_ROWS - GRID_TOP_ROWS, 0, GRID_TOP_ROWS, false);
+    int home_zone = tz_find(DESKEE_HOME_ZONE);
+    time_service_init(&app->time, home_zone >= 0 ? home_zone : 0);
+
+    app->clock_widget = app_add_widget(app, 2, 2, 0, 0);
+    widget_clock_init(app->clock_widget, &app->clock_state);
+    widget_clock_set_face_cache(&app->clock_state, clock_face_cache, SCREEN_WIDTH * SCREEN_HEIGHT);
+    widget_calendar_init(app_add_widget(app, 2, 2, 2, 0), &app->calendar_state);
+    widget_battery_init(app_add_widget(app, 1, 2, 4, 0), &app->battery_state);
+    widget_visualizer_init(app_add_widget(app, 5, 2, 0, 2), &app->visualizer_state);
+    widget_draw_init(app_add_widget(app, 5, GRID_ROWS - GRID_TOP_ROWS - 2, 0, GRID_TOP_ROWS), &app->draw_state);
+    for (int i = 0; i < APP_WORLD_CLOCKS; ++i) {
+        widget_world_clock_init(app_add_widget(app, 1, 1, i, GRID_ROWS - 2), &app->world_states[i],
+                                tz_find(app_world_cities[i]), &app->time.utc);
+    }
+    widget_digital_clock_init(app_add_widget(app, 5, 1, 0, GRID_ROWS - 1), &app->digital_state);
 
-    widget_set_rotation(&app->clock_widget, app->rotation);
-    widget_set_rotation(&app->calendar_widget, app->rotation);
-    widget_set_rotation(&app->visualizer_widget, app->rotation);
-    widget_set_rotation(&app->battery_widget, app->rotation);
-    widget_set_rotation(&app->draw_widget, app->rotation);
+    app_set_widget_rotation(app, app_widget_rotation(app));
 
     app_apply_full_layout(app);
     app_apply_theme(app);
 }
 
 int main(void) {
-    videoSetMode(MODE_FB0);
-    vramSetBankA(VRAM_A_LCD);
-    u16* framebuffer = (u16*)VRAM_A;
+    // The top screen is an extended-rotation bitmap background like the
+    // bottom one, so either can be rotated by the affine matrix
+    videoSetMode(MODE_5_2D);
+    vramSetBankA(VRAM_A_MAIN_BG_0x06000000);
+    top_bg_id = bgInit(3, BgType_Bmp16, BgSize_B16_256x256, 0, 0);
+    bgSetPriority(top_bg_id, 0);
+    bgShow(top_bg_id);
+    u16* framebuffer = bgGetGfxPtr(top_bg_id);
 
     vramSetBankC(VRAM_C_SUB_BG);
     videoSetModeSub(MODE_5_2D);
@@ -241,27 +657,91 @@ int main(void) {
     AppContext app = {
         .theme = THEME_LIGHT,
         .rotation = ROTATION_0,
-        .clock_slot = -1,
-        .calendar_slot = -1,
-        .visualizer_slot = -1,
-        .battery_slot = -1,
-        .draw_slot = -1,
-        .last_second = -1,
+        .top_buffers = {framebuffer, framebuffer + SCREEN_WIDTH * BG_BITMAP_HEIGHT},
     };
 
-    gfx_init(&app.gfx_top, framebuffer, 256, 192, ROTATION_0);
-    gfx_init(&app.gfx_bottom, bottom_framebuffer, 256, 192, ROTATION_0);
+    app_clear_offscreen_rows(framebuffer);
+    app_clear_offscreen_rows(bottom_framebuffer);
+
+    gfx_init(&app.gfx_top, framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, ROTATION_0);
+#if DESKEE_TOP_DOUBLE_BUFFER
+    vramSetBankB(VRAM_B_MAIN_BG_0x06020000);
+    app_clear_offscreen_rows(app.top_buffers[1]);
+    gfx_enable_double_buffer(&app.gfx_top, app.top_buffers[0], app.top_buffers[1]);
+#endif
+    gfx_init(&app.gfx_bottom, bottom_framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, ROTATION_0);
+#if DESKEE_COMMAND_BUFFER
+    gfx_command_list_init(&app.top_commands, top_command_arena, COMMAND_ARENA_WORDS);
+    gfx_command_list_init(&app.bottom_commands, bottom_command_arena, COMMAND_ARENA_WORDS);
+    gfx_begin_commands(&app.gfx_top, &app.top_commands);
+    gfx_begin_commands(&app.gfx_bottom, &app.bottom_commands);
+#endif
+    app_apply_bg_rotation(&app);
+
+    profile_init();
+#if DESKEE_PROFILE
+    // Time the pixel kernels once in the bottom screen's offscreen rows
+    kernel_bench_run(bottom_framebuffer + SCREEN_WIDTH * SCREEN_HEIGHT, app_bench_cycles, nocashMessage);
+    app_clear_offscreen_rows(bottom_framebuffer);
+#endif
+    font_init();
+    profile_counter_init(&app.draw_time, "draw");
+    profile_counter_init(&app.present_time, "present");
+    profile_counter_init(&app.idle_enter_time, "enter");
+    profile_counter_init(&app.idle_leave_time, "leave");
 
     app_init_widgets(&app);
+    irqSet(IRQ_VBLANK, app_vblank_irq);
+    idle_init(&app.idle, DESKEE_IDLE_SECONDS * TIME_SERVICE_FRAMES_PER_SECOND, app_vblank_count);
 
     while (1) {
-        swiWaitForVBlank();
+        // Sleep until the next VBlank. Every wake source is latched and
+        // handled here: frames are presented at VBlank anyway.
+        swiIntrWait(1, IRQ_VBLANK);
+        u32 vblanks = app_vblank_count;
+        int frames = (int)(vblanks - app.vblank_seen);
+        app.vblank_seen = vblanks;
+        app.behind = frames > 1;
+        app.late = false;
+        unsigned changed = time_service_vblank(&app.time, vblanks);
+        u32 present_start = profile_ticks();
+        app_present_vblank(&app);
+        profile_counter_add(&app.present_time, profile_ticks() - present_start);
+
         scanKeys();
+        u32 draw_start = profile_ticks();
 
         u32 keys_down = keysDown();
+        u32 keys_active = (keysHeld() | keysUp()) & ~KEY_LID;
+
+        if (keys_down & KEY_LID) {
+            // Sleep until the lid opens; nothing runs meanwhile
+            app_enter_idle(&app);
+            idle_sleep(&app.idle);
+            app_leave_idle(&app);
+            keys_down = 0;
+        }
+
+        IdleChange idle_change = idle_vblank(&app.idle, app_vblank_count, keys_active != 0);
+        if (idle_change == IDLE_CHANGE_ENTER) {
+            app_enter_idle(&app);
+        } else if (idle_change == IDLE_CHANGE_LEAVE) {
+            app_leave_idle(&app);
+        }
+
+        // The press or touch that woke the app only wakes it
+        if (app.wake_hold || app.idle.level == IDLE_DEEP) {
+            app.wake_hold = app.wake_hold && keys_active != 0;
+            keys_down = 0;
+            keys_active = 0;
+        }
 
         if (keys_down & KEY_START) break;
 
+        if (keys_active & KEY_TOUCH) {
+            widget_scheduler_signal(WIDGET_WAKE_TOUCH);
+        }
+
         if (keys_down & KEY_A) {
             app_toggle_theme(&app);
         }
@@ -280,21 +760,58 @@ int main(void) {
             app_set_rotation(&app, ROTATION_0);
         }
 
-        time_t current = time(NULL);
-        struct tm* timeinfo = localtime(&current);
+        if (keys_down & KEY_SELECT) {
+            app_set_shadow(&app, !app.shadow);
+        }
+
+        if (keys_down & KEY_L) {
+            app_set_hw_rotation(&app, !app.hw_rotation);
+        }
+
+        if (keys_down & KEY_R) {
+            widget_clock_set_antialias(&app.clock_state, !app.clock_state.config.antialias);
+        }
+
+        if (keys_down & KEY_UP) {
+            widget_clock_set_sweep(&app.clock_state, !app.clock_state.config.sweep);
+            widget_invalidate(app.clock_widget);
+        }
 
-        if (timeinfo && timeinfo->tm_sec != app.last_second) {
-            app_handle_time_tick(&app, timeinfo);
+        if (keys_down & KEY_DOWN) {
+            const DigitalClockConfig* digital = &app.digital_state.config;
+            widget_digital_clock_set_format(&app.digital_state, !digital->hour_24, digital->show_seconds,
+                                            digital->show_date);
+            app_force_time_refresh(&app);
         }
 
-        app_update_widgets(&app);
+        if (keys_down & KEY_LEFT) {
+            app_toggle_world_style(&app);
+        }
+
+        widget_clock_set_subsecond(&app.clock_state, time_service_subsecond_millis(&app.time));
+
+        changed = app_idle_time_changes(&app, changed | app.forced_changes);
+        app.forced_changes = 0;
+        bool ticked = changed && app.time.valid;
+        if (ticked) {
+            app_handle_time_tick(&app, changed);
+        }
+
+        // Idle holds widget updates; their wake sources wait until it ends
+        int woken = app.idle.level == IDLE_ACTIVE ? app_update_widgets(&app, frames)
+                                                  : app_finish_redraws(&app);
+        if (woken == 0 && !ticked) {
+            app.idle_frames++;
+        }
+        app_present_frame(&app);
+
+        profile_counter_add(&app.draw_time, profile_ticks() - draw_start);
+        app_report_profile(&app);
     }
 
-    widget_detach(&app.visualizer_widget);
-    widget_detach(&app.calendar_widget);
-    widget_detach(&app.clock_widget);
-    widget_detach(&app.battery_widget);
-    widget_detach(&app.draw_widget);
+    for (int i = 0; i < app.widget_count; ++i) {
+        widget_detach(&app.widgets[i]);
+    }
 
     return 0;
 }
@@ -0,0 +1,50 @@
+#include "profile.h"
+
+#include <stdio.h>
+
+void profile_init(void) {
+    cpuStartTiming(PROFILE_TIMER);
+}
+
+u32 profile_ticks(void) {
+    return cpuGetTiming();
+}
+
+void profile_counter_init(ProfileCounter* counter, const char* name) {
+    if (!counter) return;
+    counter->name = name;
+    profile_counter_reset(counter);
+}
+
+void profile_counter_add(ProfileCounter* counter, u32 ticks) {
+    if (!counter) return;
+    counter->total += ticks;
+    counter->samples++;
+    if (ticks > counter->max) {
+        counter->max = ticks;
+    }
+}
+
+void profile_counter_reset(ProfileCounter* counter) {
+    if (!counter) return;
+    counter->total = 0;
+    counter->max = 0;
+    counter->samples = 0;
+}
+
+u32 profile_counter_average(const ProfileCounter* counter) {
+    if (!counter || counter->samples == 0) return 0;
+    return counter->total / counter->samples;
+}
+
+void profile_counter_log(const ProfileCounter* counter, const char* prefix) {
+    if (!counter || counter->samples == 0) return;
+
+    char line[96];
+    snprintf(line, sizeof(line), "%s %s: avg %lu max %lu cycles (%lu samples)",
+             prefix ? prefix : "", counter->name ? counter->name : "?",
+             (unsigned long)(profile_counter_average(counter) * PROFILE_CYCLES_PER_TICK),
+             (unsigned long)(counter->max * PROFILE_CYCLES_PER_TICK),
+             (unsigned long)counter->samples);
+    nocashMessage(line);
+}
@@ -0,0 +1,36 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <nds.h>
+#include <stdbool.h>
+
+// On-device timing. Ticks come from a free-running cascaded hardware timer at
+// BUS_CLOCK (~33.5 MHz); the ARM9 runs at twice that rate.
+#define PROFILE_CYCLES_PER_TICK 2
+
+// Hardware timer pair used for timing (this timer and the next one)
+#define PROFILE_TIMER 2
+
+typedef struct {
+    const char* name;
+    u32 total;      // Sum of all samples, in ticks
+    u32 max;        // Largest single sample, in ticks
+    u32 samples;
+} ProfileCounter;
+
+// Start the free-running timer (call once at boot)
+void profile_init(void);
+
+// Current timer value in ticks; subtract two readings for a duration
+u32 profile_ticks(void);
+
+void profile_counter_init(ProfileCounter* counter, const char* name);
+void profile_counter_add(ProfileCounter* counter, u32 ticks);
+void profile_counter_reset(ProfileCounter* counter);
+u32 profile_counter_average(const ProfileCounter* counter);
+
+// Print "<prefix> <name>: avg/max cycles over N samples" to the emulator
+// debug console (no$gba / melonDS); a no-op on hardware
+void profile_counter_log(const ProfileCounter* counter, const char* prefix);
+
+#endif // PROFILE_H
@@ -0,0 +1,130 @@
+#include "time_service.h"
+
+#include <string.h>
+
+#include "tz.h"
+
+// Frames into a second before the RTC is read again. A second is 59.83
+// frames, so the next change falls on frame 59 or 60; reading every frame
+// from 59 on sees it within a frame and keeps the VBlank count phase-locked
+// to the RTC with one or two reads per second instead of sixty.
+#define TIME_SERVICE_READ_FRAME (TIME_SERVICE_FRAMES_PER_SECOND - 1)
+
+static const u8 time_service_month_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+static bool time_service_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Days in month `month` (0-11) of `year`
+static int time_service_days_in_month(int year, int month) {
+    return time_service_month_days[month] + (month == 1 && time_service_leap_year(year) ? 1 : 0);
+}
+
+// Full breakdown of an RTC reading, like localtime() on the DS
+static void time_service_break_down(time_t seconds, struct tm* out) {
+    TzTime time;
+    tz_break_down(seconds, &time);
+
+    memset(out, 0, sizeof(*out));
+    out->tm_year = time.year - 1900;
+    out->tm_mon = time.month - 1;
+    out->tm_mday = time.day;
+    out->tm_wday = time.weekday;
+    out->tm_hour = time.hour;
+    out->tm_min = time.minute;
+    out->tm_sec = time.second;
+    out->tm_yday = time.day - 1;
+    for (int month = 0; month < out->tm_mon; month++) {
+        out->tm_yday += time_service_days_in_month(time.year, month);
+    }
+}
+
+// Advance the broken-down time by one second
+static void time_service_step(struct tm* tm) {
+    if (++tm->tm_sec < 60) return;
+    tm->tm_sec = 0;
+    if (++tm->tm_min < 60) return;
+    tm->tm_min = 0;
+    if (++tm->tm_hour < 24) return;
+    tm->tm_hour = 0;
+    tm->tm_wday = (tm->tm_wday + 1) % 7;
+    tm->tm_yday++;
+    if (++tm->tm_mday <= time_service_days_in_month(tm->tm_year + 1900, tm->tm_mon)) return;
+    tm->tm_mday = 1;
+    if (++tm->tm_mon < 12) return;
+    tm->tm_mon = 0;
+    tm->tm_yday = 0;
+    tm->tm_year++;
+}
+
+// TimeChange bits between two readings; a larger unit sets the smaller ones
+static unsigned time_service_changes(const struct tm* before, const struct tm* after) {
+    unsigned changed = 0;
+    if (before->tm_year != after->tm_year || before->tm_mon != after->tm_mon) changed |= TIME_CHANGE_MONTH;
+    if (changed || before->tm_mday != after->tm_mday) changed |= TIME_CHANGE_DAY;
+    if (changed || before->tm_hour != after->tm_hour) changed |= TIME_CHANGE_HOUR;
+    if (changed || before->tm_min != after->tm_min) changed |= TIME_CHANGE_MINUTE;
+    if (changed || before->tm_sec != after->tm_sec) changed |= TIME_CHANGE_SECOND;
+    return changed;
+}
+
+// Read the RTC and publish what changed since the last reading
+static unsigned time_service_read(TimeService* service) {
+    time_t seconds = time(NULL);
+    service->reads++;
+    if (service->valid && seconds == service->seconds) return 0;
+
+    unsigned changed = TIME_CHANGE_ALL;
+    if (service->valid) {
+        struct tm before = service->local;
+        // A step of one second fixes the phase. After a jump (the clock was
+        // set) the phase is unknown until the next change is seen.
+        bool stepped = seconds == service->seconds + 1;
+        if (stepped) {
+            time_service_step(&service->local);
+        } else {
+            time_service_break_down(seconds, &service->local);
+        }
+        changed = time_service_changes(&before, &service->local);
+        service->second_locked = stepped;
+    } else {
+        time_service_break_down(seconds, &service->local);
+    }
+
+    if (--service->poll_wait <= 0 || !service->valid) {
+        changed |= TIME_CHANGE_POLL;
+        service->poll_wait = TIME_SERVICE_POLL_SECONDS;
+    }
+
+    service->second_frame = service->frame_count;
+    service->seconds = seconds;
+    service->utc = tz_to_utc(service->home_zone, seconds);
+    service->valid = true;
+    return changed;
+}
+
+void time_service_init(TimeService* service, int home_zone) {
+    if (!service) return;
+
+    memset(service, 0, sizeof(*service));
+    service->home_zone = home_zone;
+}
+
+unsigned time_service_vblank(TimeService* service, u32 vblank_count) {
+    if (!service) return 0;
+
+    service->frame_count = vblank_count;
+    if (service->second_locked && service->frame_count - service->second_frame < TIME_SERVICE_READ_FRAME) {
+        return 0;
+    }
+    return time_service_read(service);
+}
+
+int time_service_subsecond_millis(const TimeService* service) {
+    if (!service || !service->second_locked) return 0;
+
+    u32 frames = service->frame_count - service->second_frame;
+    if (frames > TIME_SERVICE_FRAMES_PER_SECOND) frames = TIME_SERVICE_FRAMES_PER_SECOND;
+    return (int)(frames * TIME_SERVICE_FRAME_MICROS / 1000);
+}
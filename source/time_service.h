@@ -0,0 +1,55 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <nds.h>
+#include <stdbool.h>
+#include <time.h>
+
+// One refresh of the DS LCDs (59.83 Hz)
+#define TIME_SERVICE_FRAME_MICROS 16715
+#define TIME_SERVICE_FRAMES_PER_SECOND 60
+
+// Seconds between TIME_CHANGE_POLL events, for slow status readings
+#define TIME_SERVICE_POLL_SECONDS 5
+
+// What changed since the previous update. Each bit implies the smaller
+// ones: a new minute is also a new second.
+typedef enum {
+    TIME_CHANGE_SECOND = 1 << 0,
+    TIME_CHANGE_MINUTE = 1 << 1,
+    TIME_CHANGE_HOUR = 1 << 2,
+    TIME_CHANGE_DAY = 1 << 3,
+    TIME_CHANGE_MONTH = 1 << 4,     // Also set for a new year
+    TIME_CHANGE_POLL = 1 << 5,      // Every TIME_SERVICE_POLL_SECONDS
+    TIME_CHANGE_ALL = 0x3F
+} TimeChange;
+
+// The app's clock. The RTC is read only around the expected second
+// boundary (counted in VBlanks), and the broken-down time is stepped
+// forward instead of calling localtime(); a full breakdown happens only at
+// start-up or when the RTC jumps.
+typedef struct {
+    struct tm local;        // RTC wall clock
+    time_t seconds;         // RTC reading behind `local`
+    time_t utc;             // The same instant in UTC, for zone conversions
+    int home_zone;          // tz.h zone the RTC is set in
+    bool valid;             // The RTC has been read
+    // Sub-second time base: VBlanks counted from the last second change
+    u32 frame_count;        // Latest VBlank count
+    u32 second_frame;       // frame_count when the second last changed
+    bool second_locked;     // A change has been seen, so the phase is known
+    int poll_wait;          // Seconds until the next TIME_CHANGE_POLL
+    int reads;              // RTC reads, for profiling
+} TimeService;
+
+void time_service_init(TimeService* service, int home_zone);
+
+// Call after each VBlank with the VBlank interrupt count, so frames the
+// loop missed still count. Returns the TimeChange bits of this frame, 0 on
+// most frames.
+unsigned time_service_vblank(TimeService* service, u32 vblank_count);
+
+// Milliseconds into the current second; 0 until the first boundary
+int time_service_subsecond_millis(const TimeService* service);
+
+#endif // TIME_SERVICE_H
@@ -0,0 +1,42 @@
+#include "trig.h"
+
+#include "trig_table.h"
+
+// Table entries are 0.5 degrees apart
+#define TRIG_TABLE_STEP (TRIG_TURN / 720)
+
+// Sine of an angle in [0, TRIG_QUARTER]: table lookup plus linear
+// interpolation, whose error is below 1e-5 at this step size
+static int trig_quarter_sin(int angle) {
+    int index = angle / TRIG_TABLE_STEP;
+    int frac = angle - index * TRIG_TABLE_STEP;
+    int value = trig_quarter_sine[index];
+    if (frac == 0) return value;
+
+    int next = trig_quarter_sine[index + 1];
+    return value + ((next - value) * frac + TRIG_TABLE_STEP / 2) / TRIG_TABLE_STEP;
+}
+
+int trig_sin(int angle) {
+    angle %= TRIG_TURN;
+    if (angle < 0) angle += TRIG_TURN;
+
+    int quadrant = angle / TRIG_QUARTER;
+    int offset = angle - quadrant * TRIG_QUARTER;
+    switch (quadrant) {
+        case 0:  return trig_quarter_sin(offset);
+        case 1:  return trig_quarter_sin(TRIG_QUARTER - offset);
+        case 2:  return -trig_quarter_sin(offset);
+        default: return -trig_quarter_sin(TRIG_QUARTER - offset);
+    }
+}
+
+int trig_cos(int angle) {
+    return trig_sin(angle + TRIG_QUARTER);
+}
+
+void trig_polar(int cx, int cy, int radius, int angle, int* x, int* y) {
+    // Round half up; >> floors negative products as well
+    *x = cx + ((trig_sin(angle) * radius + TRIG_ONE / 2) >> 12);
+    *y = cy - ((trig_cos(angle) * radius + TRIG_ONE / 2) >> 12);
+}
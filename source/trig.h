@@ -0,0 +1,27 @@
+#ifndef TRIG_H
+#define TRIG_H
+
+#include <nds.h>
+
+// Integer trigonometry for clock geometry. A full turn is TRIG_TURN units,
+// one per second of an hour hand's sweep, so every hand angle is an exact
+// integer: seconds * 720, (minutes * 60 + seconds) * 12 and
+// ((hours % 12) * 3600 + minutes * 60 + seconds). Results are Q12
+// (TRIG_ONE == 1.0), interpolated from a 0.5 degree quarter-wave table.
+// Their error against sin/cos is at most 1/4096.
+#define TRIG_TURN 43200
+#define TRIG_QUARTER (TRIG_TURN / 4)
+#define TRIG_ONE 4096
+
+// Angle of a whole number of degrees
+#define TRIG_DEGREES(d) ((d) * (TRIG_TURN / 360))
+
+// Sine and cosine of any angle (wrapped to one turn), in Q12
+int trig_sin(int angle);
+int trig_cos(int angle);
+
+// Point `radius` pixels from (cx, cy) at `angle`, measured clockwise from
+// 12 o'clock with y growing downwards, rounded to the nearest pixel
+void trig_polar(int cx, int cy, int radius, int angle, int* x, int* y);
+
+#endif // TRIG_H
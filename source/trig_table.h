@@ -0,0 +1,25 @@
+#ifndef TRIG_TABLE_H
+#define TRIG_TABLE_H
+
+// Generated by tools/gen_trig_table.py; do not edit.
+// sin(i * 0.5 degrees) in Q12 for i = 0..180
+static const s16 trig_quarter_sine[181] = {
+    0, 36, 71, 107, 143, 179, 214, 250, 286, 321, 357, 393,
+    428, 464, 499, 535, 570, 605, 641, 676, 711, 746, 782, 817,
+    852, 887, 921, 956, 991, 1026, 1060, 1095, 1129, 1163, 1198, 1232,
+    1266, 1300, 1334, 1367, 1401, 1434, 1468, 1501, 1534, 1567, 1600, 1633,
+    1666, 1699, 1731, 1763, 1796, 1828, 1860, 1891, 1923, 1954, 1986, 2017,
+    2048, 2079, 2110, 2140, 2171, 2201, 2231, 2261, 2290, 2320, 2349, 2379,
+    2408, 2436, 2465, 2493, 2522, 2550, 2578, 2605, 2633, 2660, 2687, 2714,
+    2741, 2767, 2793, 2820, 2845, 2871, 2896, 2921, 2946, 2971, 2996, 3020,
+    3044, 3068, 3091, 3115, 3138, 3161, 3183, 3206, 3228, 3250, 3271, 3293,
+    3314, 3335, 3355, 3376, 3396, 3416, 3435, 3455, 3474, 3492, 3511, 3529,
+    3547, 3565, 3582, 3600, 3617, 3633, 3650, 3666, 3681, 3697, 3712, 3727,
+    3742, 3756, 3770, 3784, 3798, 3811, 3824, 3837, 3849, 3861, 3873, 3884,
+    3896, 3906, 3917, 3927, 3937, 3947, 3956, 3966, 3974, 3983, 3991, 3999,
+    4006, 4014, 4021, 4027, 4034, 4040, 4046, 4051, 4056, 4061, 4065, 4070,
+    4074, 4077, 4080, 4083, 4086, 4088, 4090, 4092, 4094, 4095, 4095, 4096,
+    4096,
+};
+
+#endif // TRIG_TABLE_H
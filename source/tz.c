@@ -0,0 +1,233 @@
+#include "tz.h"
+
+#include <string.h>
+
+#define TZ_SECONDS_PER_DAY 86400
+#define TZ_DST_MINUTES 60
+
+typedef enum {
+    TZ_DST_NONE,
+    TZ_DST_EU,
+    TZ_DST_US,
+    TZ_DST_AU,      // South-east Australia
+    TZ_DST_NZ
+} TzDstRuleId;
+
+// A yearly DST period. Weeks 1-4 count Sundays from the start of the month,
+// week 5 is the last Sunday. Switch times are in local standard time, or in
+// UTC for rules that change everywhere at once. A start month after the end
+// month is a southern-hemisphere rule spanning the new year.
+typedef struct {
+    uint8_t start_month;
+    uint8_t start_week;
+    uint8_t end_month;
+    uint8_t end_week;
+    int16_t start_minutes;
+    int16_t end_minutes;
+    bool utc;
+} TzDstRule;
+
+typedef struct {
+    const char* name;
+    int16_t offset_minutes;     // Standard time
+    uint8_t rule;               // TzDstRuleId
+} TzZone;
+
+static const TzDstRule tz_rules[] = {
+    [TZ_DST_NONE] = {0, 0, 0, 0, 0, 0, false},
+    [TZ_DST_EU] = {3, 5, 10, 5, 60, 60, true},
+    [TZ_DST_US] = {3, 2, 11, 1, 120, 60, false},
+    [TZ_DST_AU] = {10, 1, 4, 1, 120, 120, false},
+    [TZ_DST_NZ] = {9, 5, 4, 1, 120, 120, false},
+};
+
+static const TzZone tz_zones[] = {
+    {"UTC", 0, TZ_DST_NONE},
+    {"Honolulu", -600, TZ_DST_NONE},
+    {"Anchorage", -540, TZ_DST_US},
+    {"Los Angeles", -480, TZ_DST_US},
+    {"Denver", -420, TZ_DST_US},
+    {"Chicago", -360, TZ_DST_US},
+    {"New York", -300, TZ_DST_US},
+    {"Sao Paulo", -180, TZ_DST_NONE},
+    {"London", 0, TZ_DST_EU},
+    {"Paris", 60, TZ_DST_EU},
+    {"Berlin", 60, TZ_DST_EU},
+    {"Athens", 120, TZ_DST_EU},
+    {"Moscow", 180, TZ_DST_NONE},
+    {"Dubai", 240, TZ_DST_NONE},
+    {"Mumbai", 330, TZ_DST_NONE},
+    {"Singapore", 480, TZ_DST_NONE},
+    {"Shanghai", 480, TZ_DST_NONE},
+    {"Tokyo", 540, TZ_DST_NONE},
+    {"Sydney", 600, TZ_DST_AU},
+    {"Auckland", 720, TZ_DST_NZ},
+};
+
+#define TZ_ZONE_COUNT ((int)(sizeof(tz_zones) / sizeof(tz_zones[0])))
+
+// Offset of each zone and the UTC interval it holds for; until <= from
+// marks an empty entry
+typedef struct {
+    int offset_minutes;
+    time_t from;
+    time_t until;
+} TzCacheEntry;
+
+static TzCacheEntry tz_cache[TZ_ZONE_COUNT];
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+static int32_t tz_days_from_civil(int year, int month, int day) {
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    int32_t year_of_era = year - era * 400;
+    int32_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+static void tz_civil_from_days(int32_t days, int* year, int* month, int* day) {
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int32_t day_of_era = days - era * 146097;
+    int32_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int32_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int32_t shifted_month = (5 * day_of_year + 2) / 153;
+    *day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+    *month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+    *year = year_of_era + era * 400 + (*month <= 2);
+}
+
+// 0 = Sunday; 1970-01-01 was a Thursday
+static int tz_weekday(int32_t days) {
+    int weekday = (days + 4) % 7;
+    return weekday < 0 ? weekday + 7 : weekday;
+}
+
+// Days since 1970 of the `week`th Sunday of a month (5 = the last one)
+static int32_t tz_nth_sunday(int year, int month, int week) {
+    if (week >= 5) {
+        int32_t last = tz_days_from_civil(month == 12 ? year + 1 : year, month == 12 ? 1 : month + 1, 1) - 1;
+        return last - tz_weekday(last);
+    }
+    int32_t first = tz_days_from_civil(year, month, 1);
+    return first + (7 - tz_weekday(first)) % 7 + (week - 1) * 7;
+}
+
+// UTC instant of a rule's start (or end) switch in `year`
+static time_t tz_switch(const TzDstRule* rule, int std_minutes, int year, bool start) {
+    int month = start ? rule->start_month : rule->end_month;
+    int week = start ? rule->start_week : rule->end_week;
+    int minutes = start ? rule->start_minutes : rule->end_minutes;
+    if (!rule->utc) minutes -= std_minutes;
+    return (time_t)tz_nth_sunday(year, month, week) * TZ_SECONDS_PER_DAY + (time_t)minutes * 60;
+}
+
+// Work out a zone's offset at `utc` and the interval between the DST
+// switches around it
+static void tz_compute(int zone, time_t utc, TzCacheEntry* entry) {
+    const TzZone* info = &tz_zones[zone];
+    const TzDstRule* rule = &tz_rules[info->rule];
+    int std = info->offset_minutes;
+
+    if (info->rule == TZ_DST_NONE) {
+        entry->offset_minutes = std;
+        entry->from = utc;
+        entry->until = utc + (time_t)366 * TZ_SECONDS_PER_DAY;
+        return;
+    }
+
+    TzTime local;
+    tz_break_down(utc + (time_t)std * 60, &local);
+    int year = local.year;
+    time_t start = tz_switch(rule, std, year, true);
+    time_t end = tz_switch(rule, std, year, false);
+
+    if (start < end) {
+        if (utc < start) {
+            entry->offset_minutes = std;
+            entry->from = tz_switch(rule, std, year - 1, false);
+            entry->until = start;
+        } else if (utc < end) {
+            entry->offset_minutes = std + TZ_DST_MINUTES;
+            entry->from = start;
+            entry->until = end;
+        } else {
+            entry->offset_minutes = std;
+            entry->from = end;
+            entry->until = tz_switch(rule, std, year + 1, true);
+        }
+    } else {
+        if (utc < end) {
+            entry->offset_minutes = std + TZ_DST_MINUTES;
+            entry->from = tz_switch(rule, std, year - 1, true);
+            entry->until = end;
+        } else if (utc < start) {
+            entry->offset_minutes = std;
+            entry->from = end;
+            entry->until = start;
+        } else {
+            entry->offset_minutes = std + TZ_DST_MINUTES;
+            entry->from = start;
+            entry->until = tz_switch(rule, std, year + 1, false);
+        }
+    }
+}
+
+int tz_count(void) {
+    return TZ_ZONE_COUNT;
+}
+
+const char* tz_name(int zone) {
+    if (zone < 0 || zone >= TZ_ZONE_COUNT) return "";
+    return tz_zones[zone].name;
+}
+
+int tz_find(const char* name) {
+    if (!name) return -1;
+    for (int i = 0; i < TZ_ZONE_COUNT; i++) {
+        if (strcmp(tz_zones[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+int tz_offset_minutes(int zone, time_t utc) {
+    if (zone < 0 || zone >= TZ_ZONE_COUNT) return 0;
+
+    TzCacheEntry* entry = &tz_cache[zone];
+    if (utc < entry->from || utc >= entry->until) {
+        tz_compute(zone, utc, entry);
+    }
+    return entry->offset_minutes;
+}
+
+time_t tz_to_utc(int zone, time_t local) {
+    if (zone < 0 || zone >= TZ_ZONE_COUNT) return local;
+
+    // Read the offset one standard offset away from the wall clock, which
+    // is the right instant except inside the switch hours
+    time_t guess = local - (time_t)tz_zones[zone].offset_minutes * 60;
+    return local - (time_t)tz_offset_minutes(zone, guess) * 60;
+}
+
+void tz_local_time(int zone, time_t utc, TzTime* out) {
+    if (!out) return;
+    tz_break_down(utc + (time_t)tz_offset_minutes(zone, utc) * 60, out);
+}
+
+void tz_break_down(time_t seconds, TzTime* out) {
+    if (!out) return;
+
+    int32_t days = (int32_t)(seconds / TZ_SECONDS_PER_DAY);
+    int32_t rest = (int32_t)(seconds - (time_t)days * TZ_SECONDS_PER_DAY);
+    if (rest < 0) {
+        rest += TZ_SECONDS_PER_DAY;
+        days--;
+    }
+
+    tz_civil_from_days(days, &out->year, &out->month, &out->day);
+    out->weekday = tz_weekday(days);
+    out->hour = rest / 3600;
+    out->minute = rest / 60 % 60;
+    out->second = rest % 60;
+}
@@ -0,0 +1,45 @@
+#ifndef TZ_H
+#define TZ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// Time zones from a compact built-in table: a city name, its standard UTC
+// offset and one of a few daylight saving rules. Offsets are cached per
+// zone until the next DST switch, so converting a UTC reading costs a
+// compare and some integer arithmetic, with no localtime() call.
+//
+// The DS RTC has no zone: it holds whatever local time the user set, so
+// callers pick the zone it is set in and convert with tz_to_utc().
+
+typedef struct {
+    int year;
+    int month;      // 1-12
+    int day;        // 1-31
+    int weekday;    // 0 = Sunday
+    int hour;
+    int minute;
+    int second;
+} TzTime;
+
+int tz_count(void);
+const char* tz_name(int zone);
+
+// Index of the zone called `name` (case-sensitive), or -1
+int tz_find(const char* name);
+
+// Offset from UTC in minutes, DST included, at the instant `utc`
+int tz_offset_minutes(int zone, time_t utc);
+
+// UTC instant of a wall-clock reading in `zone`. In the repeated hour at
+// the end of DST the later instant is returned.
+time_t tz_to_utc(int zone, time_t local);
+
+// Wall-clock time in `zone` at `utc`
+void tz_local_time(int zone, time_t utc, TzTime* out);
+
+// Break seconds since 1970 down into a date and time, like gmtime()
+void tz_break_down(time_t seconds, TzTime* out);
+
+#endif // TZ_H
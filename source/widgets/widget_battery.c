@@ -4,6 +4,10 @@
 #include <nds/system.h>
 
 #define BATTERY_CHARGE_ANIM_STEP_DELAY 4
+
+// A repaint fits easily; it may wait up to a second behind late frames
+#define BATTERY_BUDGET_CYCLES 40000
+#define BATTERY_RATE_HZ 1
 #define BATTERY_CHARGE_LIGHTEN_STEP    6
 
 #define COLOR_LIGHT_BACKGROUND ARGB16(1, 31, 31, 31)
@@ -111,7 +115,7 @@ static u16 battery_active_fill_color(const BatteryWidgetState* state) {
     return state->fill_critical_color;
 }
 
-static void battery_draw(BatteryWidgetState* state, GraphicsContext* ctx, bool is_bottom_screen) {
+static void battery_draw(BatteryWidgetState* state, GraphicsContext* ctx) {
     if (!state || !ctx || !ctx->framebuffer) return;
     if (state->width <= 0 || state->height <= 0) return;
 
@@ -200,10 +204,6 @@ static void battery_draw(BatteryWidgetState* state, GraphicsContext* ctx, bool i
 
     // Charging animation disabled
 
-    if (is_bottom_screen) {
-        bgUpdate();
-    }
-
     state->dirty = false;
 }
 
@@ -248,6 +248,7 @@ static void battery_on_time_tick(Widget* widget, const struct tm* timeinfo) {
     (void)timeinfo;
     BatteryWidgetState* state = widget_state(widget);
     battery_refresh_state(state);
+    if (state->dirty) widget_invalidate(widget);
 }
 
 static void battery_on_update(Widget* widget) {
@@ -259,7 +260,12 @@ static void battery_on_update(Widget* widget) {
 
     if (!state->dirty) return;
 
-    battery_draw(state, ctx, widget->split_mode);
+    battery_draw(state, ctx);
+}
+
+static void battery_on_bounds_changed(Widget* widget, int x, int y, int w, int h) {
+    int margin = widget_cell_margin(w, h, 40);
+    widget_battery_set_bounds(widget_state(widget), x + margin, y + margin, w - margin * 2, h - margin * 2);
 }
 
 static const WidgetOps BATTERY_WIDGET_OPS = {
@@ -268,6 +274,7 @@ static const WidgetOps BATTERY_WIDGET_OPS = {
     .on_theme_changed = battery_on_theme_changed,
     .on_rotation_changed = battery_on_rotation_changed,
     .on_layout_changed = battery_on_layout_changed,
+    .on_bounds_changed = battery_on_bounds_changed,
     .on_time_tick = battery_on_time_tick,
     .on_update = battery_on_update,
 };
@@ -289,4 +296,6 @@ void widget_battery_init(Widget* widget, BatteryWidgetState* state) {
     battery_refresh_state(state);
 
     widget_init(widget, "Battery", state, &BATTERY_WIDGET_OPS);
+    widget_subscribe_time(widget, TIME_CHANGE_POLL);
+    widget_set_budget(widget, BATTERY_RATE_HZ, BATTERY_BUDGET_CYCLES, WIDGET_PRIORITY_LOW);
 }
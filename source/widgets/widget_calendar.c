@@ -3,6 +3,8 @@
 #include <nds.h>
 #include <time.h>
 
+#include "font.h"
+
 #define COLOR_BLACK ARGB16(1, 0, 0, 0)
 #define COLOR_WHITE ARGB16(1, 31, 31, 31)
 #define COLOR_GRAY ARGB16(1, 20, 20, 20)
@@ -15,6 +17,11 @@
 #define COLOR_DARK_BORDER ARGB16(1, 31, 31, 31)
 #define COLOR_DARK_HOUR ARGB16(1, 25, 25, 25)
 
+// A redraw may use this much of a frame before the rest waits, and has to
+// finish within a second however late the frames run
+#define CALENDAR_BUDGET_CYCLES 100000
+#define CALENDAR_RATE_HZ 1
+
 static void calendar_init_config(CalendarConfig* config, int x, int y, int cell_width, int cell_height) {
     config->offset_x = x;
     config->offset_y = y;
@@ -54,6 +61,7 @@ static void calendar_widget_reset(CalendarWidgetState* state) {
     state->cached_day = -1;
     state->cached_month = -1;
     state->cached_year = -1;
+    state->redraw_step = -1;
     state->dirty = true;
 }
 
@@ -99,9 +107,9 @@ static void calendar_draw_bounds(GraphicsContext* gfx, const CalendarWidgetState
     int saved_px = gfx->pivot_x;
     int saved_py = gfx->pivot_y;
 
-    gfx->rotation = state->config.rotation;
-    gfx->pivot_x = state->bounds_x + state->bounds_width / 2;
-    gfx->pivot_y = state->bounds_y + state->bounds_height / 2;
+    gfx_set_transform(gfx, state->config.rotation,
+                      state->bounds_x + state->bounds_width / 2,
+                      state->bounds_y + state->bounds_height / 2);
 
     if (draw_fill) {
         gfx_draw_filled_rect(gfx, state->bounds_x, state->bounds_y,
@@ -113,9 +121,7 @@ static void calendar_draw_bounds(GraphicsContext* gfx, const CalendarWidgetState
                       state->bounds_width, state->bounds_height, 1, border_color);
     }
 
-    gfx->rotation = saved_rotation;
-    gfx->pivot_x = saved_px;
-    gfx->pivot_y = saved_py;
+    gfx_set_transform(gfx, saved_rotation, saved_px, saved_py);
 }
 
 static int get_days_in_month(int month, int year) {
@@ -139,92 +145,46 @@ static int get_first_day_of_month(int month, int year) {
     return (h + 6) % 7;
 }
 
-static void draw_small_number(GraphicsContext* gfx, int x, int y, int num, u16 color) {
-    const int small_nums[10][5] = {
-        {0b111, 0b101, 0b101, 0b101, 0b111},
-        {0b010, 0b110, 0b010, 0b010, 0b111},
-        {0b111, 0b001, 0b111, 0b100, 0b111},
-        {0b111, 0b001, 0b111, 0b001, 0b111},
-        {0b101, 0b101, 0b111, 0b001, 0b001},
-        {0b111, 0b100, 0b111, 0b001, 0b111},
-        {0b111, 0b100, 0b111, 0b101, 0b111},
-        {0b111, 0b001, 0b001, 0b001, 0b001},
-        {0b111, 0b101, 0b111, 0b101, 0b111},
-        {0b111, 0b101, 0b111, 0b001, 0b111},
-    };
-
-    if (num < 0 || num > 9) return;
-
-    for (int py = 0; py < 5; py++) {
-        for (int px = 0; px < 3; px++) {
-            if (small_nums[num][py] & (1 << (2 - px))) {
-                gfx_plot(gfx, x + px, y + py, color);
-            }
-        }
-    }
-}
-
-static void draw_small_letter(GraphicsContext* gfx, int x, int y, char letter, u16 color) {
-    static const int glyph_S[5] = {0b111, 0b100, 0b111, 0b001, 0b111};
-    static const int glyph_M[5] = {0b101, 0b111, 0b101, 0b101, 0b101};
-    static const int glyph_T[5] = {0b111, 0b010, 0b010, 0b010, 0b010};
-    static const int glyph_W[5] = {0b101, 0b101, 0b101, 0b111, 0b101};
-    static const int glyph_F[5] = {0b111, 0b100, 0b110, 0b100, 0b100};
-
-    const int* glyph = NULL;
-    switch (letter) {
-        case 'S': glyph = glyph_S; break;
-        case 'M': glyph = glyph_M; break;
-        case 'T': glyph = glyph_T; break;
-        case 'W': glyph = glyph_W; break;
-        case 'F': glyph = glyph_F; break;
-        default: return;
-    }
-
-    for (int py = 0; py < 5; py++) {
-        for (int px = 0; px < 3; px++) {
-            if (glyph[py] & (1 << (2 - px))) {
-                gfx_plot(gfx, x + px, y + py, color);
-            }
-        }
+// Write `value` as exactly `digits` zero-padded decimal digits
+static void calendar_format_number(char* out, int value, int digits) {
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
     }
+    out[digits] = '\0';
 }
 
-static void calendar_draw(GraphicsContext* gfx, const CalendarConfig* config,
-                          const CalendarTheme* theme, struct tm* timeinfo) {
-    RotationAngle saved_rotation = gfx->rotation;
-    int saved_px = gfx->pivot_x;
-    int saved_py = gfx->pivot_y;
-    gfx->rotation = config->rotation;
+// Steps of a calendar redraw: the background and headers, one per week row,
+// then the border. Each is a slice that fits a frame on its own.
+#define CALENDAR_STEP_HEADER 0
+#define CALENDAR_STEP_FIRST_WEEK 1
+#define CALENDAR_WEEKS 6
+#define CALENDAR_STEP_BORDER (CALENDAR_STEP_FIRST_WEEK + CALENDAR_WEEKS)
 
+static void calendar_draw_header(GraphicsContext* gfx, const CalendarConfig* config,
+                                 const CalendarTheme* theme, int month, int year) {
     int start_x = config->offset_x + 6;
     int start_y = config->offset_y + 22;
     int cell_w = config->cell_width;
     int cell_h = config->cell_height;
     int total_width = 7 * cell_w + 8;
     int total_height = 22 + 7 * cell_h;
-    gfx->pivot_x = config->offset_x + total_width / 2;
-    gfx->pivot_y = config->offset_y + total_height / 2;
 
     gfx_draw_filled_rect(gfx, config->offset_x, config->offset_y,
                          total_width, total_height, theme->background);
 
     if (config->show_month_year) {
-        int month = timeinfo->tm_mon + 1;
-        int year = timeinfo->tm_year + 1900;
-
         int header_x = config->offset_x + 10;
         int header_y = config->offset_y + 5;
 
-        draw_small_number(gfx, header_x, header_y, month / 10, theme->text);
-        draw_small_number(gfx, header_x + 4, header_y, month % 10, theme->text);
+        char text[5];
+        calendar_format_number(text, month + 1, 2);
+        gfx_draw_text(gfx, header_x, header_y, text, FONT_TINY, theme->text);
 
         gfx_plot(gfx, header_x + 9, header_y + 2, theme->text);
 
-        draw_small_number(gfx, header_x + 12, header_y, (year / 1000) % 10, theme->text);
-        draw_small_number(gfx, header_x + 16, header_y, (year / 100) % 10, theme->text);
-        draw_small_number(gfx, header_x + 20, header_y, (year / 10) % 10, theme->text);
-        draw_small_number(gfx, header_x + 24, header_y, year % 10, theme->text);
+        calendar_format_number(text, year % 10000, 4);
+        gfx_draw_text(gfx, header_x + 12, header_y, text, FONT_TINY, theme->text);
     }
 
     u16 header_colors[] = {
@@ -237,94 +197,122 @@ static void calendar_draw(GraphicsContext* gfx, const CalendarConfig* config,
         int x = start_x + day * cell_w;
         int y = start_y;
 
-        for (int py = 0; py < cell_h - 1; py++) {
-            for (int px = 0; px < cell_w - 1; px++) {
-                gfx_plot(gfx, x + px, y + py, header_colors[day]);
-            }
-        }
-
-        for (int i = 0; i < cell_w - 1; i++) {
-            gfx_plot(gfx, x + i, y, theme->border);
-            gfx_plot(gfx, x + i, y + cell_h - 2, theme->border);
-        }
-        for (int i = 0; i < cell_h - 1; i++) {
-            gfx_plot(gfx, x, y + i, theme->border);
-            gfx_plot(gfx, x + cell_w - 2, y + i, theme->border);
-        }
+        gfx_draw_filled_rect(gfx, x, y, cell_w - 1, cell_h - 1, header_colors[day]);
+        gfx_draw_rect(gfx, x, y, cell_w - 1, cell_h - 1, 1, theme->border);
 
         int letter_x = x + (cell_w - 3) / 2;
         int letter_y = y + (cell_h - 1 - 5) / 2;
-        char letter = header_labels[day];
+        char letter[2] = {header_labels[day], '\0'};
         u16 letter_color = (day == 0 || day == 6) ? theme->text_on_colored : theme->text;
-        draw_small_letter(gfx, letter_x, letter_y, letter, letter_color);
+        gfx_draw_text(gfx, letter_x, letter_y, letter, FONT_TINY, letter_color);
     }
+}
+
+// Draw the day cells of one week row (0-5) of the month
+static void calendar_draw_week(GraphicsContext* gfx, const CalendarConfig* config,
+                               const CalendarTheme* theme, int month, int year, int today, int week) {
+    int start_x = config->offset_x + 6;
+    int start_y = config->offset_y + 22;
+    int cell_w = config->cell_width;
+    int cell_h = config->cell_height;
+
+    int days_in_month = get_days_in_month(month, year);
+    int first_day = get_first_day_of_month(month, year);
+
+    for (int day = 0; day < 7; day++) {
+        int day_num = week * 7 + day - first_day + 1;
+        if (day_num < 1) {
+            continue;
+        }
+        if (day_num > days_in_month) {
+            break;
+        }
+
+        int x = start_x + day * cell_w;
+        int y = start_y + (week + 1) * cell_h;
+
+        u16 cell_bg;
+        if (day_num == today) {
+            cell_bg = theme->today;
+        } else if (day == 0) {
+            cell_bg = theme->sunday;
+        } else if (day == 6) {
+            cell_bg = theme->saturday;
+        } else {
+            cell_bg = theme->background;
+        }
+
+        gfx_draw_filled_rect(gfx, x, y, cell_w - 1, cell_h - 1, cell_bg);
+        gfx_draw_rect(gfx, x, y, cell_w - 1, cell_h - 1, 1, theme->border);
 
-    int days_in_month = get_days_in_month(timeinfo->tm_mon, timeinfo->tm_year + 1900);
-    int first_day = get_first_day_of_month(timeinfo->tm_mon, timeinfo->tm_year + 1900);
-    int today = timeinfo->tm_mday;
-
-    int day_num = 1;
-    for (int week = 0; week < 6 && day_num <= days_in_month; week++) {
-        for (int day = 0; day < 7; day++) {
-            if (week == 0 && day < first_day) {
-                continue;
-            }
-            if (day_num > days_in_month) {
-                break;
-            }
-
-            int x = start_x + day * cell_w;
-            int y = start_y + (week + 1) * cell_h;
-
-            u16 cell_bg;
-            if (day_num == today) {
-                cell_bg = theme->today;
-            } else if (day == 0) {
-                cell_bg = theme->sunday;
-            } else if (day == 6) {
-                cell_bg = theme->saturday;
-            } else {
-                cell_bg = theme->background;
-            }
-
-            for (int py = 0; py < cell_h - 1; py++) {
-                for (int px = 0; px < cell_w - 1; px++) {
-                    gfx_plot(gfx, x + px, y + py, cell_bg);
-                }
-            }
-
-            for (int i = 0; i < cell_w - 1; i++) {
-                gfx_plot(gfx, x + i, y, theme->border);
-                gfx_plot(gfx, x + i, y + cell_h - 2, theme->border);
-            }
-            for (int i = 0; i < cell_h - 1; i++) {
-                gfx_plot(gfx, x, y + i, theme->border);
-                gfx_plot(gfx, x + cell_w - 2, y + i, theme->border);
-            }
-
-            int num_x = x + 3;
-            int num_y = y + 4;
-            u16 num_color = theme->text;
-            if (day_num == today) {
-                num_color = theme->today_text;
-            } else if (day == 0 || day == 6) {
-                num_color = theme->text_on_colored;
-            }
-
-            if (day_num >= 10) {
-                draw_small_number(gfx, num_x, num_y, day_num / 10, num_color);
-                draw_small_number(gfx, num_x + 4, num_y, day_num % 10, num_color);
-            } else {
-                draw_small_number(gfx, num_x + 2, num_y, day_num, num_color);
-            }
-
-            day_num++;
+        int num_x = x + 3;
+        int num_y = y + 4;
+        u16 num_color = theme->text;
+        if (day_num == today) {
+            num_color = theme->today_text;
+        } else if (day == 0 || day == 6) {
+            num_color = theme->text_on_colored;
         }
+
+        char text[3];
+        calendar_format_number(text, day_num, day_num >= 10 ? 2 : 1);
+        // Two digits fill the 7 px slot; one digit is centered in it
+        int text_x = num_x + (7 - gfx_text_width(FONT_TINY, text)) / 2;
+        gfx_draw_text(gfx, text_x, num_y, text, FONT_TINY, num_color);
+    }
+}
+
+// Draw one step of the redraw of the cached date
+static void calendar_draw_step(GraphicsContext* gfx, const CalendarWidgetState* state,
+                               const CalendarTheme* theme, int step) {
+    if (step == CALENDAR_STEP_BORDER) {
+        calendar_draw_bounds(gfx, state, theme->background, theme->border, false, true);
+        return;
     }
 
-    gfx->rotation = saved_rotation;
-    gfx->pivot_x = saved_px;
-    gfx->pivot_y = saved_py;
+    const CalendarConfig* config = &state->config;
+    int year = state->cached_year + 1900;
+    if (step == CALENDAR_STEP_HEADER) {
+        calendar_draw_bounds(gfx, state, theme->background, theme->border, true, false);
+    }
+
+    RotationAngle saved_rotation = gfx->rotation;
+    int saved_px = gfx->pivot_x;
+    int saved_py = gfx->pivot_y;
+    gfx_set_transform(gfx, config->rotation,
+                      config->offset_x + (7 * config->cell_width + 8) / 2,
+                      config->offset_y + (22 + 7 * config->cell_height) / 2);
+
+    if (step == CALENDAR_STEP_HEADER) {
+        calendar_draw_header(gfx, config, theme, state->cached_month, year);
+    } else {
+        calendar_draw_week(gfx, config, theme, state->cached_month, year, state->cached_day,
+                           step - CALENDAR_STEP_FIRST_WEEK);
+    }
+
+    gfx_set_transform(gfx, saved_rotation, saved_px, saved_py);
+}
+
+// Draw redraw steps until the redraw is done or the widget's budget is
+// used up, in which case the rest continues on the next frame
+static void calendar_continue_redraw(Widget* widget) {
+    CalendarWidgetState* state = widget_state(widget);
+    GraphicsContext* ctx = widget_context(widget);
+    if (!state || !ctx || !ctx->framebuffer || state->redraw_step < 0) return;
+
+    CalendarTheme* theme = (widget->theme == WIDGET_THEME_LIGHT)
+                                ? &state->light_theme
+                                : &state->dark_theme;
+
+    do {
+        calendar_draw_step(ctx, state, theme, state->redraw_step++);
+    } while (state->redraw_step <= CALENDAR_STEP_BORDER && !widget_over_budget(widget));
+
+    if (state->redraw_step > CALENDAR_STEP_BORDER) {
+        state->redraw_step = -1;
+    } else {
+        widget_resume(widget);
+    }
 }
 
 static void calendar_widget_attach(Widget* widget, GraphicsContext* context) {
@@ -374,25 +362,23 @@ static void calendar_widget_time_tick(Widget* widget, const struct tm* timeinfo)
         return;
     }
 
-    CalendarTheme* theme = (widget->theme == WIDGET_THEME_LIGHT)
-                                ? &state->light_theme
-                                : &state->dark_theme;
-
-    calendar_draw_bounds(ctx, state, theme->background, theme->border, true, false);
-
-    struct tm time_copy = *timeinfo;
-    calendar_draw(ctx, &state->config, theme, &time_copy);
-
-    calendar_draw_bounds(ctx, state, theme->background, theme->border, false, true);
-
+    // Start a redraw from the top; what does not fit the budget continues
+    // in on_update on later frames
     state->cached_day = timeinfo->tm_mday;
     state->cached_month = timeinfo->tm_mon;
     state->cached_year = timeinfo->tm_year;
     state->dirty = false;
+    state->redraw_step = CALENDAR_STEP_HEADER;
+    calendar_continue_redraw(widget);
+}
 
-    if (widget->split_mode) {
-        bgUpdate();
-    }
+static void calendar_widget_update(Widget* widget) {
+    calendar_continue_redraw(widget);
+}
+
+static void calendar_widget_bounds_changed(Widget* widget, int x, int y, int w, int h) {
+    int margin = widget_cell_margin(w, h, 40);
+    widget_calendar_set_bounds(widget_state(widget), x + margin, y + margin, w - margin * 2, h - margin * 2);
 }
 
 static const WidgetOps CALENDAR_WIDGET_OPS = {
@@ -401,8 +387,9 @@ static const WidgetOps CALENDAR_WIDGET_OPS = {
     .on_theme_changed = calendar_widget_theme_changed,
     .on_rotation_changed = calendar_widget_rotation_changed,
     .on_layout_changed = calendar_widget_layout_changed,
+    .on_bounds_changed = calendar_widget_bounds_changed,
     .on_time_tick = calendar_widget_time_tick,
-    .on_update = NULL,
+    .on_update = calendar_widget_update,
 };
 
 void widget_calendar_init(Widget* widget, CalendarWidgetState* state) {
@@ -420,4 +407,6 @@ void widget_calendar_init(Widget* widget, CalendarWidgetState* state) {
     calendar_widget_reset(state);
 
     widget_init(widget, "Calendar", state, &CALENDAR_WIDGET_OPS);
+    widget_subscribe_time(widget, TIME_CHANGE_DAY);
+    widget_set_budget(widget, CALENDAR_RATE_HZ, CALENDAR_BUDGET_CYCLES, WIDGET_PRIORITY_LOW);
 }
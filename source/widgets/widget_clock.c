@@ -1,9 +1,10 @@
 #include "widgets/widget_clock.h"
 
-#include <math.h>
 #include <nds.h>
+#include <string.h>
 
-#define PI 3.14159265358979323846
+#include "font.h"
+#include "trig.h"
 
 #define COLOR_BLACK ARGB16(1, 0, 0, 0)
 #define COLOR_WHITE ARGB16(1, 31, 31, 31)
@@ -12,12 +13,23 @@
 #define COLOR_RED ARGB16(1, 31, 10, 15)
 #define COLOR_CYAN ARGB16(1, 10, 25, 31)
 
+// Clock callbacks may use this much of a frame (~1.12M ARM9 cycles at 60 Hz)
+#define CLOCK_BUDGET_CYCLES 140000
+#define CLOCK_SWEEP_MAX_INTERVAL 8
+
 typedef struct {
     RotationAngle rotation;
     int pivot_x;
     int pivot_y;
 } TransformState;
 
+static void clock_build_ramps(ClockTheme* theme) {
+    gfx_build_blend_ramp(&theme->hour_ramp, theme->background, theme->hour_hand);
+    gfx_build_blend_ramp(&theme->minute_ramp, theme->background, theme->minute_hand);
+    gfx_build_blend_ramp(&theme->second_ramp, theme->background, theme->second_hand);
+    gfx_build_blend_ramp(&theme->erase_ramp, theme->background, theme->background);
+}
+
 static void clock_init_light_theme(ClockTheme* theme) {
     theme->background = COLOR_WHITE;
     theme->foreground = COLOR_BLACK;
@@ -26,6 +38,7 @@ static void clock_init_light_theme(ClockTheme* theme) {
     theme->minute_hand = COLOR_RED;
     theme->second_hand = COLOR_CYAN;
     theme->marker = COLOR_GRAY;
+    clock_build_ramps(theme);
 }
 
 static void clock_init_dark_theme(ClockTheme* theme) {
@@ -36,49 +49,18 @@ static void clock_init_dark_theme(ClockTheme* theme) {
     theme->minute_hand = COLOR_RED;
     theme->second_hand = COLOR_CYAN;
     theme->marker = COLOR_LIGHT_GRAY;
+    clock_build_ramps(theme);
 }
 
 static void push_clock_transform(GraphicsContext* gfx, const ClockConfig* config, TransformState* state) {
     state->rotation = gfx->rotation;
     state->pivot_x = gfx->pivot_x;
     state->pivot_y = gfx->pivot_y;
-    gfx->rotation = config->rotation;
-    gfx->pivot_x = config->center_x;
-    gfx->pivot_y = config->center_y;
+    gfx_set_transform(gfx, config->rotation, config->center_x, config->center_y);
 }
 
 static void pop_clock_transform(GraphicsContext* gfx, const TransformState* state) {
-    gfx->rotation = state->rotation;
-    gfx->pivot_x = state->pivot_x;
-    gfx->pivot_y = state->pivot_y;
-}
-
-static void draw_number(GraphicsContext* gfx, int x, int y, int num, u16 color) {
-    const u8 numbers[10][5] = {
-        {0x7, 0x5, 0x5, 0x5, 0x7},
-        {0x2, 0x6, 0x2, 0x2, 0x7},
-        {0x7, 0x1, 0x7, 0x4, 0x7},
-        {0x7, 0x1, 0x7, 0x1, 0x7},
-        {0x5, 0x5, 0x7, 0x1, 0x1},
-        {0x7, 0x4, 0x7, 0x1, 0x7},
-        {0x7, 0x4, 0x7, 0x5, 0x7},
-        {0x7, 0x1, 0x1, 0x1, 0x1},
-        {0x7, 0x5, 0x7, 0x5, 0x7},
-        {0x7, 0x5, 0x7, 0x1, 0x7},
-    };
-
-    if (num < 0 || num > 9) return;
-
-    for (int row = 0; row < 5; row++) {
-        for (int col = 0; col < 3; col++) {
-            if (numbers[num][row] & (1 << (2 - col))) {
-                gfx_plot(gfx, x + col * 2, y + row * 2, color);
-                gfx_plot(gfx, x + col * 2 + 1, y + row * 2, color);
-                gfx_plot(gfx, x + col * 2, y + row * 2 + 1, color);
-                gfx_plot(gfx, x + col * 2 + 1, y + row * 2 + 1, color);
-            }
-        }
-    }
+    gfx_set_transform(gfx, state->rotation, state->pivot_x, state->pivot_y);
 }
 
 static void clock_draw_bounds(GraphicsContext* gfx, const ClockWidgetState* state,
@@ -91,9 +73,9 @@ static void clock_draw_bounds(GraphicsContext* gfx, const ClockWidgetState* stat
     int saved_px = gfx->pivot_x;
     int saved_py = gfx->pivot_y;
 
-    gfx->rotation = state->config.rotation;
-    gfx->pivot_x = state->bounds_x + state->bounds_width / 2;
-    gfx->pivot_y = state->bounds_y + state->bounds_height / 2;
+    gfx_set_transform(gfx, state->config.rotation,
+                      state->bounds_x + state->bounds_width / 2,
+                      state->bounds_y + state->bounds_height / 2);
 
     if (draw_fill) {
         gfx_draw_filled_rect(gfx, state->bounds_x, state->bounds_y,
@@ -105,37 +87,7 @@ static void clock_draw_bounds(GraphicsContext* gfx, const ClockWidgetState* stat
                       state->bounds_width, state->bounds_height, 1, border_color);
     }
 
-    gfx->rotation = saved_rotation;
-    gfx->pivot_x = saved_px;
-    gfx->pivot_y = saved_py;
-}
-
-static void draw_number_string(GraphicsContext* gfx, int center_x, int y, const char* text, u16 color) {
-    if (!text) return;
-
-    int length = 0;
-    for (const char* ptr = text; *ptr; ++ptr) {
-        if (*ptr >= '0' && *ptr <= '9') {
-            length++;
-        }
-    }
-
-    if (length == 0) {
-        return;
-    }
-
-    const int digit_width = 6;
-    const int spacing = 1;
-    int total_width = length * digit_width + (length - 1) * spacing;
-    int start_x = center_x - total_width / 2;
-    int x = start_x;
-
-    for (const char* ptr = text; *ptr; ++ptr) {
-        if (*ptr < '0' || *ptr > '9') continue;
-        int digit = *ptr - '0';
-        draw_number(gfx, x, y, digit, color);
-        x += digit_width + spacing;
-    }
+    gfx_set_transform(gfx, saved_rotation, saved_px, saved_py);
 }
 
 static void draw_numbers(GraphicsContext* gfx, const ClockConfig* config, const ClockTheme* theme) {
@@ -145,10 +97,11 @@ static void draw_numbers(GraphicsContext* gfx, const ClockConfig* config, const
     int cy = config->center_y;
     int r = config->radius;
 
-    draw_number_string(gfx, cx, cy - r + 8, "12", theme->foreground);
-    draw_number(gfx, cx + r - 14, cy - 5, 3, theme->foreground);
-    draw_number(gfx, cx - 3, cy + r - 18, 6, theme->foreground);
-    draw_number(gfx, cx - r + 8, cy - 5, 9, theme->foreground);
+    int twelve_x = cx - gfx_text_width(FONT_TINY_2X, "12") / 2;
+    gfx_draw_text(gfx, twelve_x, cy - r + 8, "12", FONT_TINY_2X, theme->foreground);
+    gfx_draw_text(gfx, cx + r - 14, cy - 5, "3", FONT_TINY_2X, theme->foreground);
+    gfx_draw_text(gfx, cx - 3, cy + r - 18, "6", FONT_TINY_2X, theme->foreground);
+    gfx_draw_text(gfx, cx - r + 8, cy - 5, "9", FONT_TINY_2X, theme->foreground);
 }
 
 static void draw_markers(GraphicsContext* gfx, const ClockConfig* config, const ClockTheme* theme) {
@@ -160,10 +113,9 @@ static void draw_markers(GraphicsContext* gfx, const ClockConfig* config, const
 
     int marker_hours[] = {1, 2, 4, 5, 7, 8, 10, 11};
     for (int i = 0; i < 8; i++) {
-        float angle = (marker_hours[i] * 30 - 90) * PI / 180.0f;
-        int mx = cx + (int)(cosf(angle) * (r - 12));
-        int my = cy + (int)(sinf(angle) * (r - 12));
-        gfx_draw_filled_rect(gfx, mx - 2, my - 2, 4, 4, theme->marker);
+        int mx, my;
+        trig_polar(cx, cy, r - 12, TRIG_DEGREES(marker_hours[i] * 30), &mx, &my);
+        gfx_fill_disc(gfx, mx, my, 2, theme->marker);
     }
 }
 
@@ -175,7 +127,8 @@ static void clock_draw_face(GraphicsContext* gfx, const ClockConfig* config, con
     TransformState state;
     push_clock_transform(gfx, config, &state);
 
-    gfx_draw_filled_rect(gfx, cx - r - 2, cy - r - 2, r * 2 + 4, r * 2 + 4, theme->background);
+    gfx_fill_disc(gfx, cx, cy, r + 2, theme->background);
+    gfx_draw_circle(gfx, cx, cy, r, theme->border);
     draw_numbers(gfx, config, theme);
     draw_markers(gfx, config, theme);
 
@@ -192,33 +145,61 @@ static void clock_draw_face_overlay(GraphicsContext* gfx, const ClockConfig* con
     pop_clock_transform(gfx, &state);
 }
 
-static void clock_draw_hands(GraphicsContext* gfx, const ClockConfig* config, const ClockTheme* theme,
-                             int hour, int minute, int second) {
+// Draw one hand aliased or anti-aliased; the erase pass must use the same
+// mode so it covers the blended edge pixels. Aliased hands taper from
+// `thickness` at the hub to `tip` with round caps.
+static void clock_draw_hand(GraphicsContext* gfx, const ClockConfig* config, int x1, int y1,
+                            int thickness, int tip, u16 color, const GfxBlendRamp* ramp) {
     int cx = config->center_x;
     int cy = config->center_y;
-    int r = config->radius;
 
-    TransformState state;
-    push_clock_transform(gfx, config, &state);
+    if (config->antialias) {
+        gfx_draw_thick_line_aa(gfx, cx, cy, x1, y1, thickness, ramp);
+    } else if (thickness > 1) {
+        gfx_draw_tapered_line(gfx, cx, cy, x1, y1, thickness, tip, color);
+    } else {
+        gfx_draw_line(gfx, cx, cy, x1, y1, color);
+    }
+}
 
-    float second_angle = (second * 6 - 90) * PI / 180.0f;
-    float minute_angle = (minute * 6 + second * 0.1f - 90) * PI / 180.0f;
-    float hour_angle = ((hour % 12) * 30 + minute * 0.5f - 90) * PI / 180.0f;
+// Hand tips for a time; the hour hand also advances with the seconds, and
+// in sweep mode the minute and second hands with the milliseconds (a second
+// is 720 trig units). Angles are exact in trig units and tips are rounded,
+// so for whole seconds and radii 10-120
+// every tip is within 0.52 pixels of the exact point on each axis, and
+// within 1 pixel of the former truncated cosf/sinf path.
+typedef struct {
+    int hour_x, hour_y;
+    int minute_x, minute_y;
+    int second_x, second_y;
+} ClockHandTips;
 
-    int hour_length = (int)(r * 0.45f);
-    int hour_x = cx + (int)(cosf(hour_angle) * hour_length);
-    int hour_y = cy + (int)(sinf(hour_angle) * hour_length);
-    gfx_draw_thick_line(gfx, cx, cy, hour_x, hour_y, 6, theme->hour_hand);
+static void clock_hand_tips(const ClockConfig* config, const ClockTime* time, ClockHandTips* tips) {
+    int cx = config->center_x;
+    int cy = config->center_y;
+    int r = config->radius;
+    int minute_seconds = time->minute * 60 + time->second;
 
-    int minute_length = (int)(r * 0.65f);
-    int minute_x = cx + (int)(cosf(minute_angle) * minute_length);
-    int minute_y = cy + (int)(sinf(minute_angle) * minute_length);
-    gfx_draw_thick_line(gfx, cx, cy, minute_x, minute_y, 5, theme->minute_hand);
+    trig_polar(cx, cy, r * 45 / 100, (time->hour % 12) * 3600 + minute_seconds, &tips->hour_x, &tips->hour_y);
+    trig_polar(cx, cy, r * 65 / 100, minute_seconds * 12 + time->millis * 12 / 1000,
+               &tips->minute_x, &tips->minute_y);
+    trig_polar(cx, cy, r * 75 / 100, time->second * 720 + time->millis * 720 / 1000,
+               &tips->second_x, &tips->second_y);
+}
 
-    int second_length = (int)(r * 0.75f);
-    int second_x = cx + (int)(cosf(second_angle) * second_length);
-    int second_y = cy + (int)(sinf(second_angle) * second_length);
-    gfx_draw_line(gfx, cx, cy, second_x, second_y, theme->second_hand);
+static void clock_draw_hands(GraphicsContext* gfx, const ClockConfig* config, const ClockTheme* theme,
+                             const ClockTime* time) {
+    int cx = config->center_x;
+    int cy = config->center_y;
+
+    TransformState state;
+    push_clock_transform(gfx, config, &state);
+
+    ClockHandTips tips;
+    clock_hand_tips(config, time, &tips);
+    clock_draw_hand(gfx, config, tips.hour_x, tips.hour_y, 6, 3, theme->hour_hand, &theme->hour_ramp);
+    clock_draw_hand(gfx, config, tips.minute_x, tips.minute_y, 5, 2, theme->minute_hand, &theme->minute_ramp);
+    clock_draw_hand(gfx, config, tips.second_x, tips.second_y, 1, 1, theme->second_hand, &theme->second_ramp);
 
     gfx_draw_filled_rect(gfx, cx - 2, cy - 2, 5, 5, theme->foreground);
 
@@ -226,50 +207,109 @@ static void clock_draw_hands(GraphicsContext* gfx, const ClockConfig* config, co
 }
 
 static void clock_erase_hands(GraphicsContext* gfx, const ClockConfig* config, const ClockTheme* theme,
-                              int hour, int minute, int second) {
-    if (hour < 0 || minute < 0 || second < 0) {
+                              const ClockTime* time) {
+    if (time->hour < 0) {
         return;
     }
 
     int cx = config->center_x;
     int cy = config->center_y;
-    int r = config->radius;
 
     TransformState state;
     push_clock_transform(gfx, config, &state);
 
-    float second_angle = (second * 6 - 90) * PI / 180.0f;
-    float minute_angle = (minute * 6 + second * 0.1f - 90) * PI / 180.0f;
-    float hour_angle = ((hour % 12) * 30 + minute * 0.5f - 90) * PI / 180.0f;
+    ClockHandTips tips;
+    clock_hand_tips(config, time, &tips);
+    clock_draw_hand(gfx, config, tips.hour_x, tips.hour_y, 6, 3, theme->background, &theme->erase_ramp);
+    clock_draw_hand(gfx, config, tips.minute_x, tips.minute_y, 5, 2, theme->background, &theme->erase_ramp);
+    clock_draw_hand(gfx, config, tips.second_x, tips.second_y, 1, 1, theme->background, &theme->erase_ramp);
+
+    gfx_draw_filled_rect(gfx, cx - 2, cy - 2, 5, 5, theme->background);
+
+    pop_clock_transform(gfx, &state);
+}
 
-    int hour_length = (int)(r * 0.45f);
-    int hour_x = cx + (int)(cosf(hour_angle) * hour_length);
-    int hour_y = cy + (int)(sinf(hour_angle) * hour_length);
-    gfx_draw_thick_line(gfx, cx, cy, hour_x, hour_y, 6, theme->background);
+// Whether the face cache can stand in for the context's framebuffer
+static bool clock_face_cache_usable(const ClockWidgetState* state, const GraphicsContext* gfx) {
+    return state->face_cache && gfx->width * gfx->height <= state->face_cache_pixels;
+}
 
-    int minute_length = (int)(r * 0.65f);
-    int minute_x = cx + (int)(cosf(minute_angle) * minute_length);
-    int minute_y = cy + (int)(sinf(minute_angle) * minute_length);
-    gfx_draw_thick_line(gfx, cx, cy, minute_x, minute_y, 5, theme->background);
+// Draw the bounds, face and border into the cache, at the same physical
+// position as on screen, then flush it so DMA reads what was drawn
+static void clock_render_face_cache(const GraphicsContext* gfx, ClockWidgetState* state,
+                                    const ClockTheme* theme) {
+    GraphicsContext face;
+    gfx_init_offscreen(&face, state->face_cache, gfx->width, gfx->height);
+    face.clip = gfx->clip;
 
-    int second_length = (int)(r * 0.75f);
-    int second_x = cx + (int)(cosf(second_angle) * second_length);
-    int second_y = cy + (int)(sinf(second_angle) * second_length);
-    gfx_draw_line(gfx, cx, cy, second_x, second_y, theme->background);
+    clock_draw_bounds(&face, state, theme->background, theme->border, true, false);
+    clock_draw_face(&face, &state->config, theme);
+    clock_draw_bounds(&face, state, theme->background, theme->border, false, true);
 
-    gfx_draw_filled_rect(gfx, cx - 2, cy - 2, 5, 5, theme->background);
+    DC_FlushRange(state->face_cache + face.clip.y * face.width,
+                  (u32)face.clip.height * face.width * sizeof(u16));
+}
 
-    pop_clock_transform(gfx, &state);
+// Copy the whole bounds from the cache to the screen
+static void clock_restore_bounds(GraphicsContext* gfx, const ClockWidgetState* state) {
+    if (state->bounds_width <= 0 || state->bounds_height <= 0) return;
+
+    TransformState saved;
+    saved.rotation = gfx->rotation;
+    saved.pivot_x = gfx->pivot_x;
+    saved.pivot_y = gfx->pivot_y;
+    gfx_set_transform(gfx, state->config.rotation,
+                      state->bounds_x + state->bounds_width / 2,
+                      state->bounds_y + state->bounds_height / 2);
+
+    gfx_restore_rect(gfx, state->face_cache, state->bounds_x, state->bounds_y,
+                     state->bounds_width, state->bounds_height);
+
+    pop_clock_transform(gfx, &saved);
+}
+
+// Restore the box a hand from the center to (x1, y1) can touch: the band of
+// a thick, tapered or anti-aliased line spreads up to thickness / 2 + 1
+static void clock_restore_hand(GraphicsContext* gfx, const ClockWidgetState* state, int x1, int y1,
+                               int thickness) {
+    int cx = state->config.center_x;
+    int cy = state->config.center_y;
+    int pad = thickness / 2 + 1;
+    int x0 = (cx < x1 ? cx : x1) - pad;
+    int y0 = (cy < y1 ? cy : y1) - pad;
+    int x2 = (cx > x1 ? cx : x1) + pad;
+    int y2 = (cy > y1 ? cy : y1) + pad;
+
+    gfx_restore_rect(gfx, state->face_cache, x0, y0, x2 - x0 + 1, y2 - y0 + 1);
+}
+
+// Put the face back under the hands drawn for a time. The hour hand's box
+// also covers the 5x5 hub.
+static void clock_restore_hands(GraphicsContext* gfx, const ClockWidgetState* state, const ClockTime* time) {
+    if (time->hour < 0) {
+        return;
+    }
+
+    TransformState saved;
+    push_clock_transform(gfx, &state->config, &saved);
+
+    ClockHandTips tips;
+    clock_hand_tips(&state->config, time, &tips);
+    clock_restore_hand(gfx, state, tips.hour_x, tips.hour_y, 6);
+    clock_restore_hand(gfx, state, tips.minute_x, tips.minute_y, 5);
+    clock_restore_hand(gfx, state, tips.second_x, tips.second_y, 1);
+
+    pop_clock_transform(gfx, &saved);
 }
 
 static void clock_widget_reset(ClockWidgetState* state) {
     if (!state) return;
 
     state->last_second = -1;
-    state->drawn_hour = -1;
-    state->drawn_minute = -1;
-    state->drawn_second = -1;
+    state->drawn.hour = -1;
+    state->sweep_interval = 1;
     state->face_dirty = true;
+    state->face_staged = false;
 }
 
 void widget_clock_set_bounds(ClockWidgetState* state, int x, int y, int width, int height) {
@@ -305,6 +345,48 @@ void widget_clock_set_bounds(ClockWidgetState* state, int x, int y, int width, i
     state->face_dirty = true;
 }
 
+// Switch the hands between aliased and anti-aliased lines. The face is
+// redrawn so no hand is left behind in the other mode.
+void widget_clock_set_antialias(ClockWidgetState* state, bool enabled) {
+    if (!state) return;
+    if (state->config.antialias == enabled) return;
+
+    state->config.antialias = enabled;
+    state->face_dirty = true;
+    profile_counter_reset(&state->hands_time);
+}
+
+// Move the second and minute hands every frame (from the sub-second set by
+// widget_clock_set_subsecond) instead of once per tick
+void widget_clock_set_sweep(ClockWidgetState* state, bool enabled) {
+    if (!state) return;
+    if (state->config.sweep == enabled) return;
+
+    state->config.sweep = enabled;
+    state->sweep_interval = 1;
+    profile_counter_reset(&state->sweep_time);
+}
+
+// Milliseconds since the current RTC second began, clamped to [0, 999]
+void widget_clock_set_subsecond(ClockWidgetState* state, int millis) {
+    if (!state) return;
+
+    if (millis < 0) millis = 0;
+    if (millis > 999) millis = 999;
+    state->subsecond = millis;
+}
+
+// Give the clock a buffer of at least the screen's pixel count to keep a
+// rendered face in. Each tick then copies the old hands' boxes back from it
+// instead of erasing them and redrawing the numbers and markers.
+void widget_clock_set_face_cache(ClockWidgetState* state, u16* buffer, int pixels) {
+    if (!state) return;
+
+    state->face_cache = buffer;
+    state->face_cache_pixels = buffer ? pixels : 0;
+    state->face_dirty = true;
+}
+
 ClockTheme* widget_clock_current_theme(ClockWidgetState* state, WidgetTheme theme) {
     if (!state) return NULL;
     return (theme == WIDGET_THEME_LIGHT) ? &state->light_theme : &state->dark_theme;
@@ -341,6 +423,55 @@ static void clock_widget_layout_changed(Widget* widget, bool split_mode) {
     clock_widget_reset(state);
 }
 
+// Bring the screen to `time`: the whole face when it is dirty, otherwise
+// just the hands. With a face cache a face redraw comes in two slices: the
+// face is rendered into the cache, and if that used up the widget's budget
+// the copy to the screen and the hands wait for the resumed update.
+// Returns whether face work was done.
+static bool clock_redraw(Widget* widget, ClockWidgetState* state, const ClockTheme* theme,
+                         const ClockTime* time) {
+    GraphicsContext* ctx = widget_context(widget);
+    bool face_redraw = state->face_dirty || state->face_staged;
+    bool cached = clock_face_cache_usable(state, ctx);
+
+    if (state->face_dirty && cached) {
+        clock_render_face_cache(ctx, state, theme);
+        state->face_dirty = false;
+        state->face_staged = true;
+        if (widget_over_budget(widget)) {
+            widget_resume(widget);
+            return true;
+        }
+    }
+
+    if (state->face_staged && cached) {
+        clock_restore_bounds(ctx, state);
+        state->face_staged = false;
+    } else if (face_redraw) {
+        clock_draw_bounds(ctx, state, theme->background, theme->border, true, false);
+        clock_draw_face(ctx, &state->config, theme);
+        state->face_dirty = false;
+        state->face_staged = false;
+    } else if (state->drawn.hour >= 0) {
+        if (cached) {
+            clock_restore_hands(ctx, state, &state->drawn);
+        } else {
+            clock_erase_hands(ctx, &state->config, theme, &state->drawn);
+            clock_draw_face_overlay(ctx, &state->config, theme);
+        }
+    }
+
+    clock_draw_hands(ctx, &state->config, theme, time);
+
+    // The cached face already has the border, and the hands stay inside it
+    if (!cached) {
+        clock_draw_bounds(ctx, state, theme->background, theme->border, false, true);
+    }
+
+    state->drawn = *time;
+    return face_redraw;
+}
+
 static void clock_widget_time_tick(Widget* widget, const struct tm* timeinfo) {
     if (!widget || !timeinfo) return;
 
@@ -348,32 +479,76 @@ static void clock_widget_time_tick(Widget* widget, const struct tm* timeinfo) {
     GraphicsContext* ctx = widget_context(widget);
     if (!state || !ctx || !ctx->framebuffer) return;
 
-    if (state->last_second == timeinfo->tm_sec && !state->face_dirty) {
+    if (state->last_second == timeinfo->tm_sec && !state->face_dirty && !state->face_staged) {
         return;
     }
 
     ClockTheme* theme = widget_clock_current_theme(state, widget->theme);
     if (!theme) return;
 
-    if (state->face_dirty) {
-        clock_draw_bounds(ctx, state, theme->background, theme->border, true, false);
-        clock_draw_face(ctx, &state->config, theme);
-        state->face_dirty = false;
-    } else if (state->drawn_second != -1) {
-        clock_erase_hands(ctx, &state->config, theme,
-                          state->drawn_hour, state->drawn_minute, state->drawn_second);
-        clock_draw_face_overlay(ctx, &state->config, theme);
+    state->time.hour = timeinfo->tm_hour;
+    state->time.minute = timeinfo->tm_min;
+    state->time.second = timeinfo->tm_sec;
+    state->time.millis = state->config.sweep ? state->subsecond : 0;
+
+    // Only steady-state ticks are timed; a full face redraw would swamp
+    // the difference between the two hand paths
+    u32 hands_start = profile_ticks();
+    if (!clock_redraw(widget, state, theme, &state->time)) {
+        profile_counter_add(&state->hands_time, profile_ticks() - hands_start);
+    }
+
+    state->last_second = timeinfo->tm_sec;
+}
+
+// Finishes a sliced face redraw, and in sweep mode follows the sub-second
+// between ticks on a wake timer of sweep_interval frames, redrawing only
+// when a hand tip moved. A redraw over budget halves the sweep rate; one
+// well under it doubles the rate back. Invalidate the widget after
+// widget_clock_set_sweep to start or stop it.
+static void clock_widget_update(Widget* widget) {
+    ClockWidgetState* state = widget_state(widget);
+    GraphicsContext* ctx = widget_context(widget);
+    if (!state || !ctx || !ctx->framebuffer) return;
+
+    widget_set_wake_timer(widget, state->config.sweep ? state->sweep_interval : 0);
+    if (state->time.hour < 0) return;
+
+    ClockTheme* theme = widget_clock_current_theme(state, widget->theme);
+    if (!theme) return;
+
+    ClockTime now = state->time;
+    if (state->config.sweep) now.millis = state->subsecond;
+    if (state->face_dirty || state->face_staged) {
+        clock_redraw(widget, state, theme, &now);
+        return;
     }
+    if (!state->config.sweep) return;
 
-    clock_draw_hands(ctx, &state->config, theme,
-                     timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
+    if (state->drawn.hour >= 0) {
+        ClockHandTips drawn_tips, tips;
+        clock_hand_tips(&state->config, &state->drawn, &drawn_tips);
+        clock_hand_tips(&state->config, &now, &tips);
+        if (memcmp(&drawn_tips, &tips, sizeof(tips)) == 0) return;
+    }
 
-    clock_draw_bounds(ctx, state, theme->background, theme->border, false, true);
+    u32 start = profile_ticks();
+    if (clock_redraw(widget, state, theme, &now)) return;
 
-    state->drawn_hour = timeinfo->tm_hour;
-    state->drawn_minute = timeinfo->tm_min;
-    state->drawn_second = timeinfo->tm_sec;
-    state->last_second = timeinfo->tm_sec;
+    u32 ticks = profile_ticks() - start;
+    profile_counter_add(&state->sweep_time, ticks);
+    u32 cycles = ticks * PROFILE_CYCLES_PER_TICK;
+    if (cycles > widget->budget_cycles && state->sweep_interval < CLOCK_SWEEP_MAX_INTERVAL) {
+        state->sweep_interval *= 2;
+    } else if (cycles < widget->budget_cycles / 4 && state->sweep_interval > 1) {
+        state->sweep_interval /= 2;
+    }
+    widget_set_wake_timer(widget, state->sweep_interval);
+}
+
+static void clock_widget_bounds_changed(Widget* widget, int x, int y, int w, int h) {
+    int margin = widget_cell_margin(w, h, 40);
+    widget_clock_set_bounds(widget_state(widget), x + margin, y + margin, w - margin * 2, h - margin * 2);
 }
 
 static const WidgetOps CLOCK_WIDGET_OPS = {
@@ -382,8 +557,9 @@ static const WidgetOps CLOCK_WIDGET_OPS = {
     .on_theme_changed = clock_widget_theme_changed,
     .on_rotation_changed = clock_widget_rotation_changed,
     .on_layout_changed = clock_widget_layout_changed,
+    .on_bounds_changed = clock_widget_bounds_changed,
     .on_time_tick = clock_widget_time_tick,
-    .on_update = NULL,
+    .on_update = clock_widget_update,
 };
 
 void widget_clock_init(Widget* widget, ClockWidgetState* state) {
@@ -394,14 +570,23 @@ void widget_clock_init(Widget* widget, ClockWidgetState* state) {
     state->config.radius = 60;
     state->config.show_numbers = true;
     state->config.show_markers = true;
+    state->config.antialias = false;
+    state->config.sweep = false;
     state->config.rotation = ROTATION_0;
     state->bounds_x = 0;
     state->bounds_y = 0;
     state->bounds_width = 0;
     state->bounds_height = 0;
+    state->face_cache = NULL;
+    state->face_cache_pixels = 0;
+    state->time.hour = -1;
+    state->subsecond = 0;
     clock_init_light_theme(&state->light_theme);
     clock_init_dark_theme(&state->dark_theme);
+    profile_counter_init(&state->hands_time, "clock hands");
+    profile_counter_init(&state->sweep_time, "clock sweep");
     clock_widget_reset(state);
 
     widget_init(widget, "Clock", state, &CLOCK_WIDGET_OPS);
+    widget_set_budget(widget, TIME_SERVICE_FRAMES_PER_SECOND, CLOCK_BUDGET_CYCLES, WIDGET_PRIORITY_HIGH);
 }
@@ -0,0 +1,382 @@
+#include "widgets/widget_digital_clock.h"
+
+#include <nds.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "color.h"
+#include "font.h"
+
+#define COLOR_BLACK ARGB16(1, 0, 0, 0)
+#define COLOR_WHITE ARGB16(1, 31, 31, 31)
+#define COLOR_GRAY ARGB16(1, 16, 16, 16)
+#define COLOR_LIGHT_GRAY ARGB16(1, 22, 22, 22)
+
+// Weight of an unlit segment between background and lit color, in 1/32
+#define DIGITAL_SEGMENT_OFF_WEIGHT 3
+
+// Space between the bounds and the content
+#define DIGITAL_PADDING 3
+
+// A tick repaints one or two cells; a full repaint should still fit this
+#define DIGITAL_BUDGET_CYCLES 80000
+
+// Segments a-g of each digit: bit 0 = top, then clockwise, bit 6 = middle
+static const u8 digital_segments[10] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F,
+};
+
+static const char* const digital_weekdays[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char* const digital_months[12] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec",
+};
+
+static void digital_init_light_theme(DigitalClockTheme* theme) {
+    theme->background = COLOR_WHITE;
+    theme->border = COLOR_BLACK;
+    theme->segment = COLOR_BLACK;
+    theme->segment_off = color_lerp(theme->background, theme->segment, DIGITAL_SEGMENT_OFF_WEIGHT);
+    theme->text = COLOR_GRAY;
+}
+
+static void digital_init_dark_theme(DigitalClockTheme* theme) {
+    theme->background = COLOR_BLACK;
+    theme->border = COLOR_WHITE;
+    theme->segment = COLOR_WHITE;
+    theme->segment_off = color_lerp(theme->background, theme->segment, DIGITAL_SEGMENT_OFF_WEIGHT);
+    theme->text = COLOR_LIGHT_GRAY;
+}
+
+// Segment bits for a time character; ' ' is a blank digit
+static int digital_char_segments(char ch) {
+    return (ch >= '0' && ch <= '9') ? digital_segments[ch - '0'] : 0;
+}
+
+// Width of a time cell for its character in the widest format
+static int digital_cell_width(char pattern, int digit_width, int thickness) {
+    return pattern == ':' ? thickness * 3 : digit_width;
+}
+
+// Character pattern of the time row for the current format
+static const char* digital_time_pattern(const DigitalClockConfig* config) {
+    return config->show_seconds ? "00:00:00" : "00:00";
+}
+
+// Lay out a row of `count` equal text cells starting at (x, y)
+static void digital_layout_text_row(DigitalClockRow* row, int x, int y, int count, FontId font) {
+    int advance = gfx_text_width(font, "00") - gfx_text_width(font, "0");
+    row->x = x;
+    row->y = y;
+    row->count = count;
+    row->cell_height = gfx_text_height(font, "0");
+    for (int i = 0; i < count; i++) {
+        row->cell_x[i] = x + i * advance;
+        row->cell_width[i] = gfx_text_width(font, "0");
+    }
+}
+
+// Fit the largest digits into the bounds, leaving room for the AM/PM and
+// date lines, and center the result
+static void digital_layout(DigitalClockWidgetState* state) {
+    const DigitalClockConfig* config = &state->config;
+    const char* pattern = digital_time_pattern(config);
+    int count = (int)strlen(pattern);
+
+    int inner_width = state->bounds_width - DIGITAL_PADDING * 2;
+    int inner_height = state->bounds_height - DIGITAL_PADDING * 2;
+    int text_height = gfx_text_height(FONT_SMALL, "0");
+    int date_height = config->show_date ? text_height + DIGITAL_PADDING : 0;
+    int suffix_width = config->hour_24 ? 0 : gfx_text_width(FONT_SMALL, "PM") + DIGITAL_PADDING;
+
+    // Digits are half as wide as tall, segments 1/8 of the height thick
+    int digit_height = inner_height - date_height;
+    int digit_width = 0;
+    int thickness = 1;
+    int time_width = 0;
+    for (; digit_height >= 5; digit_height--) {
+        digit_width = digit_height / 2;
+        thickness = digit_height / 8 > 1 ? digit_height / 8 : 1;
+        time_width = thickness * (count - 1);
+        for (int i = 0; i < count; i++) {
+            time_width += digital_cell_width(pattern[i], digit_width, thickness);
+        }
+        if (time_width + suffix_width <= inner_width) break;
+    }
+    if (digit_height < 5) {
+        digit_height = 0;
+        time_width = 0;
+    }
+
+    int top = state->bounds_y + (state->bounds_height - digit_height - date_height) / 2;
+    int left = state->bounds_x + (state->bounds_width - time_width - suffix_width) / 2;
+
+    DigitalClockRow* time_row = &state->time_row;
+    time_row->x = left;
+    time_row->y = top;
+    time_row->count = digit_height > 0 ? count : 0;
+    time_row->cell_height = digit_height;
+    int x = left;
+    for (int i = 0; i < time_row->count; i++) {
+        time_row->cell_x[i] = x;
+        time_row->cell_width[i] = digital_cell_width(pattern[i], digit_width, thickness);
+        x += time_row->cell_width[i] + thickness;
+    }
+    state->thickness = thickness;
+
+    digital_layout_text_row(&state->suffix_row, left + time_width + DIGITAL_PADDING, top,
+                            config->hour_24 || digit_height == 0 ? 0 : 2, FONT_SMALL);
+
+    int date_width = gfx_text_width(FONT_SMALL, "Wed 16 Oct 2026");
+    bool date_fits = config->show_date && date_width <= inner_width && date_height <= inner_height;
+    digital_layout_text_row(&state->date_row, state->bounds_x + (state->bounds_width - date_width) / 2,
+                            top + digit_height + DIGITAL_PADDING, date_fits ? DIGITAL_DATE_CHARS : 0,
+                            FONT_SMALL);
+
+    state->dirty = true;
+}
+
+// Switch to the widget rotation, pivoting on the bounds center; the caller
+// restores the saved transform
+static void digital_push_transform(GraphicsContext* gfx, const DigitalClockWidgetState* state,
+                                   RotationAngle* saved_rotation, int* saved_px, int* saved_py) {
+    *saved_rotation = gfx->rotation;
+    *saved_px = gfx->pivot_x;
+    *saved_py = gfx->pivot_y;
+    gfx_set_transform(gfx, state->config.rotation,
+                      state->bounds_x + state->bounds_width / 2,
+                      state->bounds_y + state->bounds_height / 2);
+}
+
+// Paint the segments in `changed` of a digit cell lit or unlit as `lit` says
+static void digital_draw_segments(GraphicsContext* gfx, const DigitalClockTheme* theme,
+                                  int x, int y, int w, int h, int t, int lit, int changed) {
+    int mid = y + (h - t) / 2;
+    int upper = mid - (y + t);
+    int lower = y + h - t - (mid + t);
+    int rects[7][4] = {
+        {x + t, y, w - 2 * t, t},               // a: top
+        {x + w - t, y + t, t, upper},           // b: upper right
+        {x + w - t, mid + t, t, lower},         // c: lower right
+        {x + t, y + h - t, w - 2 * t, t},       // d: bottom
+        {x, mid + t, t, lower},                 // e: lower left
+        {x, y + t, t, upper},                   // f: upper left
+        {x + t, mid, w - 2 * t, t},             // g: middle
+    };
+
+    for (int i = 0; i < 7; i++) {
+        if (!(changed & (1 << i))) continue;
+        u16 color = (lit & (1 << i)) ? theme->segment : theme->segment_off;
+        gfx_draw_filled_rect(gfx, rects[i][0], rects[i][1], rects[i][2], rects[i][3], color);
+    }
+}
+
+// Repaint the time cells whose character differs from `text`. Digits only
+// repaint the segments that switch; a colon is drawn once.
+static void digital_update_time_row(GraphicsContext* gfx, DigitalClockWidgetState* state,
+                                    const DigitalClockTheme* theme, const char* text) {
+    DigitalClockRow* row = &state->time_row;
+    int t = state->thickness;
+
+    for (int i = 0; i < row->count; i++) {
+        char ch = text[i];
+        char old = row->drawn[i];
+        if (ch == old) continue;
+
+        int x = row->cell_x[i];
+        int w = row->cell_width[i];
+        int h = row->cell_height;
+        if (ch == ':') {
+            int dot_x = x + (w - t) / 2;
+            gfx_draw_filled_rect(gfx, dot_x, row->y + h / 3 - t / 2, t, t, theme->segment);
+            gfx_draw_filled_rect(gfx, dot_x, row->y + h * 2 / 3 - t / 2, t, t, theme->segment);
+        } else {
+            // A blank cell (old == '\0') has no segments painted yet
+            int lit = digital_char_segments(ch);
+            int changed = old == '\0' ? 0x7F : lit ^ digital_char_segments(old);
+            digital_draw_segments(gfx, theme, x, row->y, w, h, t, lit, changed);
+        }
+        row->drawn[i] = ch;
+        state->cells_drawn++;
+    }
+}
+
+// Repaint the text cells whose character differs from `text`
+static void digital_update_text_row(GraphicsContext* gfx, DigitalClockWidgetState* state,
+                                    DigitalClockRow* row, const DigitalClockTheme* theme, const char* text) {
+    for (int i = 0; i < row->count; i++) {
+        char ch = text[i];
+        if (ch == row->drawn[i]) continue;
+
+        int x = row->cell_x[i];
+        if (row->drawn[i] != '\0') {
+            gfx_draw_filled_rect(gfx, x, row->y, row->cell_width[i], row->cell_height, theme->background);
+        }
+        char glyph[2] = {ch, '\0'};
+        gfx_draw_text(gfx, x, row->y, glyph, FONT_SMALL, theme->text);
+        row->drawn[i] = ch;
+        state->cells_drawn++;
+    }
+}
+
+static void digital_reset_rows(DigitalClockWidgetState* state) {
+    memset(state->time_row.drawn, 0, sizeof(state->time_row.drawn));
+    memset(state->suffix_row.drawn, 0, sizeof(state->suffix_row.drawn));
+    memset(state->date_row.drawn, 0, sizeof(state->date_row.drawn));
+}
+
+void widget_digital_clock_set_bounds(DigitalClockWidgetState* state, int x, int y, int width, int height) {
+    if (!state) return;
+
+    state->bounds_x = x;
+    state->bounds_y = y;
+    state->bounds_width = width;
+    state->bounds_height = height;
+    digital_layout(state);
+}
+
+// Choose 12/24-hour time, seconds and the date line; the widget is laid out
+// again and fully repainted on the next tick
+void widget_digital_clock_set_format(DigitalClockWidgetState* state, bool hour_24, bool show_seconds,
+                                     bool show_date) {
+    if (!state) return;
+
+    state->config.hour_24 = hour_24;
+    state->config.show_seconds = show_seconds;
+    state->config.show_date = show_date;
+    digital_layout(state);
+}
+
+static void digital_widget_attach(Widget* widget, GraphicsContext* context) {
+    (void)context;
+    DigitalClockWidgetState* state = widget_state(widget);
+    state->config.rotation = widget->rotation;
+    state->dirty = true;
+}
+
+static void digital_widget_detach(Widget* widget) {
+    DigitalClockWidgetState* state = widget_state(widget);
+    state->dirty = true;
+}
+
+static void digital_widget_theme_changed(Widget* widget, WidgetTheme theme) {
+    (void)theme;
+    DigitalClockWidgetState* state = widget_state(widget);
+    state->dirty = true;
+}
+
+static void digital_widget_rotation_changed(Widget* widget, RotationAngle rotation) {
+    DigitalClockWidgetState* state = widget_state(widget);
+    state->config.rotation = rotation;
+    state->dirty = true;
+}
+
+static void digital_widget_layout_changed(Widget* widget, bool split_mode) {
+    (void)split_mode;
+    DigitalClockWidgetState* state = widget_state(widget);
+    state->config.rotation = widget->rotation;
+    state->dirty = true;
+}
+
+// Format the three rows. Cells keep their positions across ticks: the
+// 12-hour format blanks a leading zero instead of shifting the digits.
+static void digital_format(const DigitalClockConfig* config, const struct tm* timeinfo,
+                           char* time_text, char* suffix_text, char* date_text) {
+    int hour = timeinfo->tm_hour;
+    char tens = (char)('0' + hour / 10);
+    if (!config->hour_24) {
+        hour = hour % 12 == 0 ? 12 : hour % 12;
+        tens = hour >= 10 ? '1' : ' ';
+    }
+
+    time_text[0] = tens;
+    time_text[1] = (char)('0' + hour % 10);
+    time_text[2] = ':';
+    time_text[3] = (char)('0' + timeinfo->tm_min / 10);
+    time_text[4] = (char)('0' + timeinfo->tm_min % 10);
+    time_text[5] = ':';
+    time_text[6] = (char)('0' + timeinfo->tm_sec / 10);
+    time_text[7] = (char)('0' + timeinfo->tm_sec % 10);
+    time_text[config->show_seconds ? 8 : 5] = '\0';
+
+    strcpy(suffix_text, timeinfo->tm_hour < 12 ? "AM" : "PM");
+
+    int weekday = timeinfo->tm_wday >= 0 && timeinfo->tm_wday < 7 ? timeinfo->tm_wday : 0;
+    int month = timeinfo->tm_mon >= 0 && timeinfo->tm_mon < 12 ? timeinfo->tm_mon : 0;
+    snprintf(date_text, DIGITAL_DATE_CHARS + 1, "%s %2d %s %04d", digital_weekdays[weekday],
+             timeinfo->tm_mday, digital_months[month], (timeinfo->tm_year + 1900) % 10000);
+}
+
+static void digital_widget_time_tick(Widget* widget, const struct tm* timeinfo) {
+    if (!widget || !timeinfo) return;
+
+    DigitalClockWidgetState* state = widget_state(widget);
+    GraphicsContext* ctx = widget_context(widget);
+    if (!state || !ctx || !ctx->framebuffer) return;
+    if (state->bounds_width <= 0 || state->bounds_height <= 0) return;
+
+    const DigitalClockTheme* theme = (widget->theme == WIDGET_THEME_LIGHT)
+                                         ? &state->light_theme
+                                         : &state->dark_theme;
+
+    char time_text[DIGITAL_TIME_CHARS + 1];
+    char suffix_text[3];
+    char date_text[DIGITAL_DATE_CHARS + 1];
+    digital_format(&state->config, timeinfo, time_text, suffix_text, date_text);
+
+    RotationAngle saved_rotation;
+    int saved_px, saved_py;
+    digital_push_transform(ctx, state, &saved_rotation, &saved_px, &saved_py);
+
+    state->cells_drawn = 0;
+    if (state->dirty) {
+        gfx_draw_filled_rect(ctx, state->bounds_x, state->bounds_y,
+                             state->bounds_width, state->bounds_height, theme->background);
+        gfx_draw_rect(ctx, state->bounds_x, state->bounds_y,
+                      state->bounds_width, state->bounds_height, 1, theme->border);
+        digital_reset_rows(state);
+        state->dirty = false;
+    }
+
+    digital_update_time_row(ctx, state, theme, time_text);
+    digital_update_text_row(ctx, state, &state->suffix_row, theme, suffix_text);
+    digital_update_text_row(ctx, state, &state->date_row, theme, date_text);
+
+    gfx_set_transform(ctx, saved_rotation, saved_px, saved_py);
+}
+
+static void digital_widget_bounds_changed(Widget* widget, int x, int y, int w, int h) {
+    int margin = widget_cell_margin(w, h, 40);
+    widget_digital_clock_set_bounds(widget_state(widget), x + margin, y + margin, w - margin * 2, h - margin * 2);
+}
+
+static const WidgetOps DIGITAL_CLOCK_WIDGET_OPS = {
+    .on_attach = digital_widget_attach,
+    .on_detach = digital_widget_detach,
+    .on_theme_changed = digital_widget_theme_changed,
+    .on_rotation_changed = digital_widget_rotation_changed,
+    .on_layout_changed = digital_widget_layout_changed,
+    .on_bounds_changed = digital_widget_bounds_changed,
+    .on_time_tick = digital_widget_time_tick,
+    .on_update = NULL,
+};
+
+void widget_digital_clock_init(Widget* widget, DigitalClockWidgetState* state) {
+    if (!widget || !state) return;
+
+    state->config.hour_24 = true;
+    state->config.show_seconds = true;
+    state->config.show_date = true;
+    state->config.rotation = ROTATION_0;
+    state->bounds_x = 0;
+    state->bounds_y = 0;
+    state->bounds_width = 0;
+    state->bounds_height = 0;
+    state->cells_drawn = 0;
+    digital_init_light_theme(&state->light_theme);
+    digital_init_dark_theme(&state->dark_theme);
+    digital_layout(state);
+    digital_reset_rows(state);
+
+    widget_init(widget, "Digital clock", state, &DIGITAL_CLOCK_WIDGET_OPS);
+    widget_set_budget(widget, 1, DIGITAL_BUDGET_CYCLES, WIDGET_PRIORITY_HIGH);
+}
@@ -1,9 +1,10 @@
 #include "widgets/widget_draw.h"
 
 #include <nds.h>
-#include <stdlib.h>
 #include <string.h>
 
+#include "geom.h"
+
 #define COLOR_LIGHT_BACKGROUND ARGB16(1, 27, 27, 29)
 #define COLOR_LIGHT_CANVAS     ARGB16(1, 31, 31, 31)
 #define COLOR_LIGHT_INFO_BG    ARGB16(1, 24, 24, 27)
@@ -22,6 +23,9 @@
 
 #define BRUSH_SIZE 3
 
+// Strokes follow the pen every frame, so the canvas is never deferred
+#define DRAW_BUDGET_CYCLES 100000
+
 
 
 
@@ -50,6 +54,7 @@ static void draw_apply_theme(DrawWidgetState* state, WidgetTheme theme) {
         state->text_color = COLOR_LIGHT_TEXT;
         state->pen_color = COLOR_LIGHT_PEN;
     }
+    gfx_build_blend_ramp(&state->clear_mark_ramp, state->info_background_color, COLOR_RED);
     // Changing theme should not erase the user's canvas drawing.
     // Redraw only the UI elements (info bar, border, checkboxes) so the
     // canvas pixels are preserved. Mark instructions_dirty so the
@@ -129,8 +134,8 @@ static void draw_render_clear_checkbox(GraphicsContext* ctx, DrawWidgetState* st
     int y1 = y + size - inset - 1;
 
     // Diagonal lines
-    gfx_draw_thick_line(ctx, x0, y0, x1, y1, thickness, COLOR_RED);
-    gfx_draw_thick_line(ctx, x0, y1, x1, y0, thickness, COLOR_RED);
+    gfx_draw_thick_line_aa(ctx, x0, y0, x1, y1, thickness, &state->clear_mark_ramp);
+    gfx_draw_thick_line_aa(ctx, x0, y1, x1, y0, thickness, &state->clear_mark_ramp);
 
     draw_restore_context(ctx, saved_rotation, saved_px, saved_py);
 }
@@ -180,19 +185,16 @@ static void draw_render_instructions(GraphicsContext* ctx, DrawWidgetState* stat
     state->instructions_dirty = false;
 }
 
+// Round brush. The center is pulled in from the canvas edges so the disc
+// never spills onto the border.
 static void draw_brush(GraphicsContext* ctx, DrawWidgetState* state, int x, int y, u16 color) {
     if (!ctx || !ctx->framebuffer || !state) return;
-    int half = BRUSH_SIZE / 2;
-    int min_x = clamp_int(x - half, state->canvas_x, state->canvas_x + state->canvas_width - 1);
-    int max_x = clamp_int(x + half, state->canvas_x, state->canvas_x + state->canvas_width - 1);
-    int min_y = clamp_int(y - half, state->canvas_y, state->canvas_y + state->canvas_height - 1);
-    int max_y = clamp_int(y + half, state->canvas_y, state->canvas_y + state->canvas_height - 1);
-
-    for (int py = min_y; py <= max_y; ++py) {
-        for (int px = min_x; px <= max_x; ++px) {
-            gfx_plot(ctx, px, py, color);
-        }
-    }
+    int radius = BRUSH_SIZE / 2;
+    if (state->canvas_width <= radius * 2 || state->canvas_height <= radius * 2) return;
+
+    x = clamp_int(x, state->canvas_x + radius, state->canvas_x + state->canvas_width - 1 - radius);
+    y = clamp_int(y, state->canvas_y + radius, state->canvas_y + state->canvas_height - 1 - radius);
+    gfx_fill_disc(ctx, x, y, radius, color);
 }
 
 static void draw_stroke(GraphicsContext* ctx, DrawWidgetState* state,
@@ -209,18 +211,13 @@ static void draw_stroke(GraphicsContext* ctx, DrawWidgetState* state,
     x1 = clamp_int(x1, min_x, max_x);
     y1 = clamp_int(y1, min_y, max_y);
 
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-    int steps = dx > dy ? dx : dy;
-    if (steps == 0) {
-        draw_brush(ctx, state, x0, y0, color);
-        return;
-    }
-
+    // One brush stamp per pixel along the major axis, stepped without
+    // dividing
+    GeomDda dda;
+    int steps = geom_dda_init(&dda, x0, y0, x1, y1);
     for (int i = 0; i <= steps; ++i) {
-        int x = x0 + (x1 - x0) * i / steps;
-        int y = y0 + (y1 - y0) * i / steps;
-        draw_brush(ctx, state, x, y, color);
+        draw_brush(ctx, state, dda.x, dda.y, color);
+        geom_dda_next(&dda);
     }
 }
 
@@ -337,26 +334,22 @@ static void draw_on_update(Widget* widget) {
     GraphicsContext* ctx = widget_context(widget);
     if (!state || !ctx || !ctx->framebuffer) return;
 
-    bool updated = false;
-
     if (state->needs_full_clear) {
         draw_clear_canvas(ctx, state);
-        updated = true;
     }
 
-    bool input_updated = false;
     if (widget->split_mode) {
-        input_updated = draw_handle_touch(ctx, widget);
+        draw_handle_touch(ctx, widget);
     }
 
     if (state->instructions_dirty) {
         draw_render_instructions(ctx, state);
-        updated = true;
     }
+}
 
-    if ((updated || input_updated) && widget->split_mode) {
-        bgUpdate();
-    }
+// The canvas frames the whole cell itself
+static void draw_on_bounds_changed(Widget* widget, int x, int y, int w, int h) {
+    widget_draw_set_bounds(widget_state(widget), x, y, w, h);
 }
 
 static const WidgetOps DRAW_WIDGET_OPS = {
@@ -365,6 +358,7 @@ static const WidgetOps DRAW_WIDGET_OPS = {
     .on_theme_changed = draw_on_theme_changed,
     .on_rotation_changed = draw_on_rotation_changed,
     .on_layout_changed = draw_on_layout_changed,
+    .on_bounds_changed = draw_on_bounds_changed,
     .on_time_tick = draw_on_time_tick,
     .on_update = draw_on_update,
 };
@@ -381,6 +375,9 @@ void widget_draw_init(Widget* widget, DrawWidgetState* state) {
     state->instructions_dirty = true;
 
     widget_init(widget, "Canvas", state, &DRAW_WIDGET_OPS);
+    widget_subscribe_time(widget, 0);
+    widget_subscribe_wake(widget, WIDGET_WAKE_TOUCH);
+    widget_set_budget(widget, TIME_SERVICE_FRAMES_PER_SECOND, DRAW_BUDGET_CYCLES, WIDGET_PRIORITY_HIGH);
 }
 
 void widget_draw_set_bounds(DrawWidgetState* state, int x, int y, int width, int height) {
@@ -66,12 +66,18 @@ static void placeholder_on_update(Widget* widget) {
     placeholder_draw(state, ctx);
 }
 
+// The placeholder frames the whole cell itself
+static void placeholder_on_bounds_changed(Widget* widget, int x, int y, int w, int h) {
+    widget_placeholder_set_bounds(widget_state(widget), x, y, w, h);
+}
+
 static const WidgetOps PLACEHOLDER_WIDGET_OPS = {
     .on_attach = placeholder_on_attach,
     .on_detach = placeholder_on_detach,
     .on_theme_changed = placeholder_on_theme_changed,
     .on_rotation_changed = NULL,
     .on_layout_changed = placeholder_on_layout_changed,
+    .on_bounds_changed = placeholder_on_bounds_changed,
     .on_time_tick = NULL,
     .on_update = placeholder_on_update,
 };
@@ -90,4 +96,5 @@ void widget_placeholder_init(Widget* widget, PlaceholderWidgetState* state) {
     state->dirty = true;
 
     widget_init(widget, "Placeholder", state, &PLACEHOLDER_WIDGET_OPS);
+    widget_set_budget(widget, 1, 0, WIDGET_PRIORITY_LOW);
 }
@@ -0,0 +1,76 @@
+#include "widgets/widget_scheduler.h"
+
+#include <nds.h>
+
+// Events signalled since the last run; interrupts may add to it
+static volatile unsigned scheduler_events;
+
+void widget_scheduler_signal(unsigned events) {
+    u32 ime = enterCriticalSection();
+    scheduler_events |= events;
+    leaveCriticalSection(ime);
+}
+
+// Count down a widget's timer; true when it fired during these frames
+static bool scheduler_timer_fired(Widget* widget, int frames) {
+    if (widget->wake_period <= 0) return false;
+
+    widget->wake_countdown -= frames;
+    if (widget->wake_countdown > 0) return false;
+
+    // Frames missed under load fire once, not once per period
+    widget->wake_countdown += widget->wake_period;
+    if (widget->wake_countdown <= 0) widget->wake_countdown = widget->wake_period;
+    return true;
+}
+
+// Whether a low-priority widget waits for a later frame. The governor is
+// asked only for those, and only while waiting keeps the widget within its
+// rate: at 30 Hz an update may slip one frame, never two.
+static bool scheduler_defer(Widget* widget, int frames, WidgetGovernor governor, void* context) {
+    if (!governor || widget->priority != WIDGET_PRIORITY_LOW) return false;
+
+    if (widget->rate_hz > 0 &&
+        widget->deferred_frames + frames >= TIME_SERVICE_FRAMES_PER_SECOND / widget->rate_hz) {
+        return false;
+    }
+    if (!governor(context)) return false;
+
+    widget->deferred_frames += frames;
+    return true;
+}
+
+int widget_scheduler_run(Widget* widgets, int count, int frames, WidgetGovernor governor, void* context) {
+    if (!widgets) return 0;
+
+    u32 ime = enterCriticalSection();
+    unsigned events = scheduler_events;
+    scheduler_events = 0;
+    leaveCriticalSection(ime);
+
+    int ran = 0;
+    for (int i = 0; i < count; ++i) {
+        Widget* widget = &widgets[i];
+        unsigned reasons = widget->wake_pending | (events & widget->wake_mask);
+        if (scheduler_timer_fired(widget, frames)) reasons |= WIDGET_WAKE_TIMER;
+        if (!reasons) continue;
+
+        if (!widget->ops || !widget->ops->on_update) {
+            widget->wake_pending = 0;
+            continue;
+        }
+        if (scheduler_defer(widget, frames, governor, context)) {
+            widget->wake_pending = reasons;
+            widget->deferrals++;
+            continue;
+        }
+
+        widget->wake_pending = 0;
+        widget->deferred_frames = 0;
+        widget->wake_reasons = reasons;
+        widget_update(widget);
+        widget->wake_reasons = 0;
+        ran++;
+    }
+    return ran;
+}
@@ -1,4 +1,8 @@
 #include "widgets/widget_visualizer.h"
+#include "widgets/widget_scheduler.h"
+
+#include "color.h"
+#include "geom.h"
 
 #include <malloc.h>
 #include <nds/arm9/sound.h>
@@ -11,28 +15,17 @@
 
 #define CLAMP(value, minv, maxv) (((value) < (minv)) ? (minv) : (((value) > (maxv)) ? (maxv) : (value)))
 
+// The bars are decoration: late frames may hold them back, but they still
+// move at least every other frame
+#define VISUALIZER_BUDGET_CYCLES 120000
+#define VISUALIZER_RATE_HZ 30
+
 static SoundVisualizer* g_active_visualizer = NULL;
 
 static inline u16 pack_color(int r, int g, int b) {
     return (u16)(RGB15(r, g, b) | BIT(15));
 }
 
-static u16 lerp_color(u16 start, u16 end, int index, int max_index) {
-    int r0 = start & 0x1F;
-    int g0 = (start >> 5) & 0x1F;
-    int b0 = (start >> 10) & 0x1F;
-
-    int r1 = end & 0x1F;
-    int g1 = (end >> 5) & 0x1F;
-    int b1 = (end >> 10) & 0x1F;
-
-    int r = r0 + (r1 - r0) * index / max_index;
-    int g = g0 + (g1 - g0) * index / max_index;
-    int b = b0 + (b1 - b0) * index / max_index;
-
-    return pack_color(r, g, b);
-}
-
 static size_t align32(size_t value) {
     return (value + 31) & ~((size_t)31);
 }
@@ -54,7 +47,7 @@ static void visualizer_calculate_layout(SoundVisualizer* viz) {
         available_width = viz->num_bars;
     }
 
-    viz->bar_width = available_width / viz->num_bars;
+    viz->bar_width = geom_div(available_width, viz->num_bars);
     if (viz->bar_width < 3) {
         viz->bar_width = 3;
     }
@@ -83,13 +76,12 @@ static void visualizer_build_palette(SoundVisualizer* viz) {
         viz->baseline_color = pack_color(6, 8, 16);
         viz->border_color = pack_color(10, 12, 20);
 
+        // Highlights brighten by up to 6 red, 3 green and 2 blue steps
+        // towards the last bar
+        color_gradient(viz->bar_colors, viz->num_bars, start, end);
+        color_gradient(viz->highlight_colors, viz->num_bars, RGB15(0, 0, 0), RGB15(6, 3, 2));
         for (int i = 0; i < viz->num_bars; ++i) {
-            viz->bar_colors[i] = lerp_color(start, end, i, viz->num_bars - 1);
-            int highlight_shift = (i * 6) / (viz->num_bars - 1);
-            int r = CLAMP(((viz->bar_colors[i] & 0x1F) + highlight_shift), 0, 31);
-            int g = CLAMP((((viz->bar_colors[i] >> 5) & 0x1F) + highlight_shift / 2), 0, 31);
-            int b = CLAMP((((viz->bar_colors[i] >> 10) & 0x1F) + highlight_shift / 3), 0, 31);
-            viz->highlight_colors[i] = pack_color(r, g, b);
+            viz->highlight_colors[i] = color_add_sat(viz->bar_colors[i], viz->highlight_colors[i]);
         }
     } else {
         viz->background_color = pack_color(31, 31, 31);
@@ -98,13 +90,10 @@ static void visualizer_build_palette(SoundVisualizer* viz) {
         viz->baseline_color = pack_color(18, 20, 27);
         viz->border_color = pack_color(0, 0, 0);
 
+        color_gradient(viz->bar_colors, viz->num_bars, start, end);
+        color_gradient(viz->highlight_colors, viz->num_bars, RGB15(4, 4, 2), RGB15(8, 8, 4));
         for (int i = 0; i < viz->num_bars; ++i) {
-            viz->bar_colors[i] = lerp_color(start, end, i, viz->num_bars - 1);
-            int highlight_shift = 4 + (i * 4) / (viz->num_bars - 1);
-            int r = CLAMP(((viz->bar_colors[i] & 0x1F) + highlight_shift), 0, 31);
-            int g = CLAMP((((viz->bar_colors[i] >> 5) & 0x1F) + highlight_shift), 0, 31);
-            int b = CLAMP((((viz->bar_colors[i] >> 10) & 0x1F) + highlight_shift / 2), 0, 31);
-            viz->highlight_colors[i] = pack_color(r, g, b);
+            viz->highlight_colors[i] = color_add_sat(viz->bar_colors[i], viz->highlight_colors[i]);
         }
     }
 
@@ -119,7 +108,6 @@ static void visualizer_clear_frame(SoundVisualizer* viz) {
     int y = viz->bounds_y;
     gfx_draw_filled_rect(viz->ctx, x, y, w, h, viz->background_color);
     gfx_draw_rect(viz->ctx, x, y, w, h, 1, viz->border_color);
-    bgUpdate();
 }
 
 static void visualizer_draw(SoundVisualizer* viz) {
@@ -163,8 +151,6 @@ static void visualizer_draw(SoundVisualizer* viz) {
     if (width > 0 && height > 0) {
         gfx_draw_rect(viz->ctx, x0, y0, width, height, 1, viz->border_color);
     }
-
-    bgUpdate();
 }
 
 static void visualizer_reset_levels(SoundVisualizer* viz) {
@@ -174,11 +160,24 @@ static void visualizer_reset_levels(SoundVisualizer* viz) {
     viz->frame_ready = false;
 }
 
+// Runs in the microphone interrupt, so it must not touch the math
+// coprocessor: the divisors only change with the buffer size, and their
+// reciprocals are cached the first time each size is seen
 static void visualizer_handle_samples(SoundVisualizer* viz, s16* samples, int sample_count) {
     if (!viz || viz->num_bars <= 0 || sample_count <= 0) return;
 
-    int chunk = sample_count / viz->num_bars;
-    if (chunk <= 0) chunk = 1;
+    if (sample_count != viz->reduce_samples || viz->num_bars != viz->reduce_bars) {
+        int chunk = sample_count / viz->num_bars;
+        if (chunk <= 0) chunk = 1;
+        viz->reduce_samples = sample_count;
+        viz->reduce_bars = viz->num_bars;
+        viz->reduce_chunk = chunk;
+        // Exact while accum * chunk < 2^31; accum is at most 32768 * chunk
+        viz->reduce_chunk_recip = chunk <= 256 ? geom_reciprocal((u32)chunk) : 0;
+    }
+
+    int chunk = viz->reduce_chunk;
+    int max_height = viz->max_height;
 
     for (int i = 0; i < viz->num_bars; ++i) {
         int start = i * chunk;
@@ -202,11 +201,14 @@ static void visualizer_handle_samples(SoundVisualizer* viz, s16* samples, int sa
             if (value > peak) peak = value;
         }
 
-        int average = accum / count;
+        // Only the last bar can have a count other than the chunk size
+        int average = (count == chunk && viz->reduce_chunk_recip)
+                          ? (int)geom_div_recip((u32)accum, viz->reduce_chunk_recip)
+                          : accum / count;
         int amplitude = (average * 3 + peak) / 4;
         amplitude = CLAMP(amplitude, 0, viz->max_sample);
-        int height = (amplitude * viz->max_height) / viz->max_sample;
-        height = CLAMP(height, 0, viz->max_height);
+        int height = (int)geom_div_recip((u32)(amplitude * max_height), viz->max_sample_recip);
+        height = CLAMP(height, 0, max_height);
         viz->target_heights[i] = (u16)height;
     }
 
@@ -223,6 +225,7 @@ static void visualizer_mic_callback(void* data, int length) {
     if (sample_count <= 0) return;
 
     visualizer_handle_samples(g_active_visualizer, (s16*)data, sample_count);
+    widget_scheduler_signal(WIDGET_WAKE_MIC);
 }
 
 static void visualizer_init(SoundVisualizer* viz, GraphicsContext* ctx) {
@@ -238,6 +241,7 @@ static void visualizer_init(SoundVisualizer* viz, GraphicsContext* ctx) {
     }
     viz->num_bars = VISUALIZER_MAX_BARS;
     viz->max_sample = 2048;
+    viz->max_sample_recip = geom_reciprocal((u32)viz->max_sample);
     viz->sample_rate = 8192;
     viz->mic_buffer_bytes = align32((size_t)(viz->sample_rate * sizeof(s16) * 2 / 30));
     viz->mic_buffer = (s16*)memalign(32, viz->mic_buffer_bytes);
@@ -273,6 +277,29 @@ static void visualizer_set_theme(SoundVisualizer* viz, VisualizerTheme theme) {
     viz->force_redraw = true;
 }
 
+static void visualizer_mic_on(SoundVisualizer* viz) {
+    if (!viz->mic_buffer || viz->mic_running || viz->mic_paused) return;
+
+    if (soundMicRecord(viz->mic_buffer, viz->mic_buffer_bytes, MicFormat_12Bit, viz->sample_rate, visualizer_mic_callback)) {
+        viz->mic_running = true;
+        g_active_visualizer = viz;
+    } else {
+        g_active_visualizer = NULL;
+    }
+}
+
+static void visualizer_mic_off(SoundVisualizer* viz) {
+    if (viz->mic_running) {
+        soundMicOff();
+        viz->mic_running = false;
+    }
+
+    viz->frame_ready = false;
+    if (g_active_visualizer == viz) {
+        g_active_visualizer = NULL;
+    }
+}
+
 static void visualizer_start(SoundVisualizer* viz) {
     if (!viz || !viz->ctx || !viz->ctx->framebuffer) return;
 
@@ -284,30 +311,14 @@ static void visualizer_start(SoundVisualizer* viz) {
     viz->visible = true;
     viz->force_redraw = true;
 
-    if (viz->mic_buffer && !viz->mic_running) {
-        if (soundMicRecord(viz->mic_buffer, viz->mic_buffer_bytes, MicFormat_12Bit, viz->sample_rate, visualizer_mic_callback)) {
-            viz->mic_running = true;
-            g_active_visualizer = viz;
-        } else {
-            g_active_visualizer = NULL;
-        }
-    }
+    visualizer_mic_on(viz);
 }
 
 static void visualizer_stop(SoundVisualizer* viz) {
     if (!viz) return;
 
-    if (viz->mic_running) {
-        soundMicOff();
-        viz->mic_running = false;
-    }
-
+    visualizer_mic_off(viz);
     viz->visible = false;
-    viz->frame_ready = false;
-    if (g_active_visualizer == viz) {
-        g_active_visualizer = NULL;
-    }
-
     visualizer_reset_levels(viz);
 }
 
@@ -316,8 +327,9 @@ static void visualizer_force_redraw(SoundVisualizer* viz) {
     viz->force_redraw = true;
 }
 
-static void visualizer_update(SoundVisualizer* viz) {
-    if (!viz || !viz->visible || !viz->ctx || !viz->ctx->framebuffer) return;
+// Step the bars toward the latest levels; returns whether any moved
+static bool visualizer_update(SoundVisualizer* viz) {
+    if (!viz || !viz->visible || !viz->ctx || !viz->ctx->framebuffer) return false;
 
     if (viz->layout_dirty) {
         visualizer_calculate_layout(viz);
@@ -352,11 +364,12 @@ static void visualizer_update(SoundVisualizer* viz) {
     }
 
     if (!updated) {
-        return;
+        return false;
     }
 
     viz->force_redraw = false;
     visualizer_draw(viz);
+    return true;
 }
 
 static void visualizer_widget_update_running(Widget* widget) {
@@ -433,11 +446,17 @@ static void visualizer_widget_time_tick(Widget* widget, const struct tm* timeinf
     (void)timeinfo;
 }
 
+// Wakes on each microphone buffer, then every frame while the bars are
+// still easing toward it
 static void visualizer_widget_update(Widget* widget) {
     VisualizerWidgetState* state = widget_state(widget);
-    if (!state || !state->initialized || !state->running) return;
+    if (!state || !state->initialized || !state->running) {
+        widget_set_wake_timer(widget, 0);
+        return;
+    }
 
-    visualizer_update(&state->visualizer);
+    bool moving = visualizer_update(&state->visualizer);
+    widget_set_wake_timer(widget, moving ? 1 : 0);
 }
 
 void widget_visualizer_set_bounds(VisualizerWidgetState* state, int x, int y, int width, int height) {
@@ -451,12 +470,34 @@ void widget_visualizer_set_bounds(VisualizerWidgetState* state, int x, int y, in
     viz->force_redraw = true;
 }
 
+// Stop the microphone while the app is idle and restart it afterwards.
+// The bars stay on screen as they are and resume from the next buffer.
+void widget_visualizer_set_mic_paused(VisualizerWidgetState* state, bool paused) {
+    if (!state || !state->initialized) return;
+
+    SoundVisualizer* viz = &state->visualizer;
+    if (viz->mic_paused == paused) return;
+
+    viz->mic_paused = paused;
+    if (paused) {
+        visualizer_mic_off(viz);
+    } else if (state->running) {
+        visualizer_mic_on(viz);
+    }
+}
+
+static void visualizer_widget_bounds_changed(Widget* widget, int x, int y, int w, int h) {
+    int margin = widget_cell_margin(w, h, 32);
+    widget_visualizer_set_bounds(widget_state(widget), x + margin, y + margin, w - margin * 2, h - margin * 2);
+}
+
 static const WidgetOps VISUALIZER_WIDGET_OPS = {
     .on_attach = visualizer_widget_attach,
     .on_detach = visualizer_widget_detach,
     .on_theme_changed = visualizer_widget_theme_changed,
     .on_rotation_changed = visualizer_widget_rotation_changed,
     .on_layout_changed = visualizer_widget_layout_changed,
+    .on_bounds_changed = visualizer_widget_bounds_changed,
     .on_time_tick = visualizer_widget_time_tick,
     .on_update = visualizer_widget_update,
 };
@@ -467,4 +508,7 @@ void widget_visualizer_init(Widget* widget, VisualizerWidgetState* state) {
     state->initialized = false;
     state->running = false;
     widget_init(widget, "Visualizer", state, &VISUALIZER_WIDGET_OPS);
+    widget_subscribe_time(widget, 0);
+    widget_subscribe_wake(widget, WIDGET_WAKE_MIC);
+    widget_set_budget(widget, VISUALIZER_RATE_HZ, VISUALIZER_BUDGET_CYCLES, WIDGET_PRIORITY_LOW);
 }
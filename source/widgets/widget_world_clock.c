@@ -0,0 +1,245 @@
+#include "widgets/widget_world_clock.h"
+
+#include <nds.h>
+#include <string.h>
+
+#include "font.h"
+#include "trig.h"
+
+#define COLOR_BLACK ARGB16(1, 0, 0, 0)
+#define COLOR_WHITE ARGB16(1, 31, 31, 31)
+#define COLOR_GRAY ARGB16(1, 16, 16, 16)
+#define COLOR_LIGHT_GRAY ARGB16(1, 22, 22, 22)
+#define COLOR_FACE_LIGHT ARGB16(1, 28, 28, 28)
+#define COLOR_FACE_DARK ARGB16(1, 6, 6, 6)
+#define COLOR_RED ARGB16(1, 31, 10, 15)
+
+// Space between the bounds, the rows and the face
+#define WORLD_CLOCK_PADDING 2
+
+// Longest city name drawn; longer names are cut to the bounds anyway
+#define WORLD_CLOCK_NAME_CHARS 15
+
+// One repaint of the small cell, once a minute
+#define WORLD_CLOCK_BUDGET_CYCLES 60000
+
+static const char* const world_clock_weekdays[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+
+static void world_clock_init_light_theme(WorldClockTheme* theme) {
+    theme->background = COLOR_WHITE;
+    theme->border = COLOR_BLACK;
+    theme->face = COLOR_FACE_LIGHT;
+    theme->hands = COLOR_BLACK;
+    theme->text = COLOR_GRAY;
+    theme->label = COLOR_RED;
+}
+
+static void world_clock_init_dark_theme(WorldClockTheme* theme) {
+    theme->background = COLOR_BLACK;
+    theme->border = COLOR_WHITE;
+    theme->face = COLOR_FACE_DARK;
+    theme->hands = COLOR_WHITE;
+    theme->text = COLOR_LIGHT_GRAY;
+    theme->label = COLOR_RED;
+}
+
+// Draw `text` centered on x, cut short to fit `max_width`
+static void world_clock_draw_centered(GraphicsContext* gfx, int cx, int y, int max_width, const char* text,
+                                      FontId font, u16 color) {
+    char buffer[WORLD_CLOCK_NAME_CHARS + 1];
+    strncpy(buffer, text, WORLD_CLOCK_NAME_CHARS);
+    buffer[WORLD_CLOCK_NAME_CHARS] = '\0';
+
+    int length = (int)strlen(buffer);
+    while (length > 0 && gfx_text_width(font, buffer) > max_width) {
+        buffer[--length] = '\0';
+    }
+    if (length == 0) return;
+
+    gfx_draw_text(gfx, cx - gfx_text_width(font, buffer) / 2, y, buffer, font, color);
+}
+
+// Face with hour and minute hands, centered in the given area
+static void world_clock_draw_face(GraphicsContext* gfx, const WorldClockTheme* theme, const TzTime* local,
+                                  int x, int y, int w, int h) {
+    int radius = (w < h ? w : h) / 2 - 1;
+    if (radius < 4) return;
+
+    int cx = x + w / 2;
+    int cy = y + h / 2;
+    gfx_fill_disc(gfx, cx, cy, radius, theme->face);
+    gfx_draw_circle(gfx, cx, cy, radius, theme->border);
+    gfx_plot(gfx, cx, cy - radius + 2, theme->border);
+
+    int hx, hy, mx, my;
+    trig_polar(cx, cy, radius / 2, (local->hour % 12) * 3600 + local->minute * 60, &hx, &hy);
+    trig_polar(cx, cy, radius * 4 / 5, local->minute * 720, &mx, &my);
+    gfx_draw_thick_line(gfx, cx, cy, hx, hy, 2, theme->hands);
+    gfx_draw_line(gfx, cx, cy, mx, my, theme->hands);
+}
+
+// Repaint the whole widget for `local`. It changes once a minute, so the
+// small area is simply filled and drawn again.
+static void world_clock_draw(GraphicsContext* gfx, const WorldClockWidgetState* state,
+                             const WorldClockTheme* theme, const TzTime* local) {
+    int x = state->bounds_x;
+    int y = state->bounds_y;
+    int w = state->bounds_width;
+    int h = state->bounds_height;
+    int inner_width = w - WORLD_CLOCK_PADDING * 2;
+    int cx = x + w / 2;
+    int line_height = gfx_text_height(FONT_TINY, "0");
+
+    gfx_draw_filled_rect(gfx, x, y, w, h, theme->background);
+    gfx_draw_rect(gfx, x, y, w, h, 1, theme->border);
+
+    int label_y = y + WORLD_CLOCK_PADDING;
+    int weekday_y = y + h - WORLD_CLOCK_PADDING - line_height;
+    world_clock_draw_centered(gfx, cx, label_y, inner_width, tz_name(state->zone), FONT_TINY, theme->label);
+    world_clock_draw_centered(gfx, cx, weekday_y, inner_width, world_clock_weekdays[local->weekday % 7],
+                              FONT_TINY, theme->text);
+
+    int area_y = label_y + line_height + WORLD_CLOCK_PADDING;
+    int area_height = weekday_y - WORLD_CLOCK_PADDING - area_y;
+    if (area_height <= 0) return;
+
+    if (state->style == WORLD_CLOCK_ANALOG) {
+        world_clock_draw_face(gfx, theme, local, x + WORLD_CLOCK_PADDING, area_y, inner_width, area_height);
+        return;
+    }
+
+    char text[6] = {
+        (char)('0' + local->hour / 10), (char)('0' + local->hour % 10), ':',
+        (char)('0' + local->minute / 10), (char)('0' + local->minute % 10), '\0',
+    };
+    FontId font = FONT_SMALL_2X;
+    if (gfx_text_width(font, text) > inner_width || gfx_text_height(font, text) > area_height) {
+        font = FONT_SMALL;
+    }
+    int text_y = area_y + (area_height - gfx_text_height(font, text)) / 2;
+    world_clock_draw_centered(gfx, cx, text_y, inner_width, text, font, theme->text);
+}
+
+void widget_world_clock_set_bounds(WorldClockWidgetState* state, int x, int y, int width, int height) {
+    if (!state) return;
+
+    state->bounds_x = x;
+    state->bounds_y = y;
+    state->bounds_width = width;
+    state->bounds_height = height;
+    state->dirty = true;
+}
+
+void widget_world_clock_set_zone(WorldClockWidgetState* state, int zone) {
+    if (!state || zone < 0 || zone >= tz_count()) return;
+
+    state->zone = zone;
+    state->dirty = true;
+}
+
+void widget_world_clock_set_style(WorldClockWidgetState* state, WorldClockStyle style) {
+    if (!state) return;
+
+    state->style = style;
+    state->dirty = true;
+}
+
+static void world_clock_widget_attach(Widget* widget, GraphicsContext* context) {
+    (void)context;
+    WorldClockWidgetState* state = widget_state(widget);
+    state->rotation = widget->rotation;
+    state->dirty = true;
+}
+
+static void world_clock_widget_detach(Widget* widget) {
+    WorldClockWidgetState* state = widget_state(widget);
+    state->dirty = true;
+}
+
+static void world_clock_widget_theme_changed(Widget* widget, WidgetTheme theme) {
+    (void)theme;
+    WorldClockWidgetState* state = widget_state(widget);
+    state->dirty = true;
+}
+
+static void world_clock_widget_rotation_changed(Widget* widget, RotationAngle rotation) {
+    WorldClockWidgetState* state = widget_state(widget);
+    state->rotation = rotation;
+    state->dirty = true;
+}
+
+static void world_clock_widget_layout_changed(Widget* widget, bool split_mode) {
+    (void)split_mode;
+    WorldClockWidgetState* state = widget_state(widget);
+    state->rotation = widget->rotation;
+    state->dirty = true;
+}
+
+static void world_clock_widget_bounds_changed(Widget* widget, int x, int y, int w, int h) {
+    int margin = widget_cell_margin(w, h, 40);
+    widget_world_clock_set_bounds(widget_state(widget), x + margin, y + margin, w - margin * 2, h - margin * 2);
+}
+
+// Ticks once a minute. The tick's timeinfo is the home zone's wall clock;
+// the city time comes from the shared UTC reading instead
+static void world_clock_widget_time_tick(Widget* widget, const struct tm* timeinfo) {
+    (void)timeinfo;
+
+    WorldClockWidgetState* state = widget_state(widget);
+    GraphicsContext* ctx = widget_context(widget);
+    if (!state || !state->utc || !ctx || !ctx->framebuffer) return;
+    if (state->bounds_width <= 0 || state->bounds_height <= 0) return;
+
+    TzTime local;
+    tz_local_time(state->zone, *state->utc, &local);
+    if (!state->dirty && local.minute == state->drawn.minute && local.hour == state->drawn.hour &&
+        local.weekday == state->drawn.weekday) {
+        return;
+    }
+
+    const WorldClockTheme* theme = (widget->theme == WIDGET_THEME_LIGHT)
+                                       ? &state->light_theme
+                                       : &state->dark_theme;
+
+    RotationAngle saved_rotation = ctx->rotation;
+    int saved_px = ctx->pivot_x;
+    int saved_py = ctx->pivot_y;
+    gfx_set_transform(ctx, state->rotation,
+                      state->bounds_x + state->bounds_width / 2,
+                      state->bounds_y + state->bounds_height / 2);
+
+    world_clock_draw(ctx, state, theme, &local);
+
+    gfx_set_transform(ctx, saved_rotation, saved_px, saved_py);
+
+    state->drawn = local;
+    state->dirty = false;
+}
+
+static const WidgetOps WORLD_CLOCK_WIDGET_OPS = {
+    .on_attach = world_clock_widget_attach,
+    .on_detach = world_clock_widget_detach,
+    .on_theme_changed = world_clock_widget_theme_changed,
+    .on_rotation_changed = world_clock_widget_rotation_changed,
+    .on_layout_changed = world_clock_widget_layout_changed,
+    .on_bounds_changed = world_clock_widget_bounds_changed,
+    .on_time_tick = world_clock_widget_time_tick,
+    .on_update = NULL,
+};
+
+void widget_world_clock_init(Widget* widget, WorldClockWidgetState* state, int zone, const time_t* utc) {
+    if (!widget || !state) return;
+
+    memset(state, 0, sizeof(*state));
+    state->zone = (zone >= 0 && zone < tz_count()) ? zone : 0;
+    state->style = WORLD_CLOCK_ANALOG;
+    state->rotation = ROTATION_0;
+    state->utc = utc;
+    state->dirty = true;
+    world_clock_init_light_theme(&state->light_theme);
+    world_clock_init_dark_theme(&state->dark_theme);
+
+    widget_init(widget, "World clock", state, &WORLD_CLOCK_WIDGET_OPS);
+    widget_subscribe_time(widget, TIME_CHANGE_MINUTE);
+    widget_set_budget(widget, 1, WORLD_CLOCK_BUDGET_CYCLES, WIDGET_PRIORITY_LOW);
+}
@@ -0,0 +1,23 @@
+#!/usr/bin/env python3
+# Regenerate source/trig_table.h, the quarter-wave Q12 sine table used by
+# trig.c (0.5 degree steps, 181 entries including both ends):
+#
+#   python3 tools/gen_trig_table.py > source/trig_table.h
+import math
+
+STEPS = 180
+ONE = 4096
+
+values = [round(math.sin(math.pi / 2 * i / STEPS) * ONE) for i in range(STEPS + 1)]
+
+print("#ifndef TRIG_TABLE_H")
+print("#define TRIG_TABLE_H")
+print()
+print("// Generated by tools/gen_trig_table.py; do not edit.")
+print("// sin(i * 0.5 degrees) in Q12 for i = 0..%d" % STEPS)
+print("static const s16 trig_quarter_sine[%d] = {" % (STEPS + 1))
+for row in range(0, len(values), 12):
+    print("    " + ", ".join("%d" % v for v in values[row:row + 12]) + ",")
+print("};")
+print()
+print("#endif // TRIG_TABLE_H")
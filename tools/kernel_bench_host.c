@@ -0,0 +1,35 @@
+// Host run of the pixel kernel benchmark (C versions only):
+//
+//   cc -O2 -Isource tools/kernel_bench_host.c source/kernel_bench.c source/kernels.c -o kernel_bench
+//   ./kernel_bench
+//
+// Cycles come from the time-stamp counter on x86; elsewhere nanoseconds are
+// reported in their place.
+#include <stdio.h>
+#include <time.h>
+
+#include "kernel_bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+
+static uint32_t host_cycles(void) {
+    return (uint32_t)__rdtsc();
+}
+#else
+static uint32_t host_cycles(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+}
+#endif
+
+static void host_log(const char* line) {
+    puts(line);
+}
+
+int main(void) {
+    static uint16_t buffer[KERNEL_BENCH_PIXELS + 2];
+    kernel_bench_run(buffer, host_cycles, host_log);
+    return 0;
+}